@@ -0,0 +1,49 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Allocates items contiguously, in chunks: one allocation per chunk instead of per item, plus a small reference controller per item
+// Each item is destroyed as soon as it is not referenced anymore, so that weak pointers to it and to what it owns expire
+// A chunk is freed once all of its items are destroyed
+template<typename T, int32 ChunkSize = 64>
+class TPropertyHistoryArena
+{
+public:
+	TSharedRef<T> Add(T&& Item)
+	{
+		if (!Chunk ||
+			Chunk->Num == ChunkSize)
+		{
+			Chunk = MakeShared<FChunk>();
+		}
+
+		T* NewItem = new (&Chunk->Items[Chunk->Num]) T(MoveTemp(Item));
+		Chunk->Num++;
+
+		return TSharedRef<T>(NewItem, FDeleter{ Chunk.ToSharedRef() });
+	}
+
+private:
+	struct FChunk
+	{
+		TTypeCompatibleBytes<T> Items[ChunkSize];
+		int32 Num = 0;
+
+		FChunk() = default;
+		UE_NONCOPYABLE(FChunk);
+	};
+	// Only destroys the item: its memory belongs to the chunk, which the deleter keeps alive
+	struct FDeleter
+	{
+		TSharedRef<FChunk> Chunk;
+
+		void operator()(T* Item) const
+		{
+			Item->~T();
+		}
+	};
+	// Chunk new items are added to, older chunks are only kept alive by their items
+	TSharedPtr<FChunk> Chunk;
+};
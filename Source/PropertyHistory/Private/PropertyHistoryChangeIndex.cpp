@@ -0,0 +1,462 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryChangeIndex.h"
+#include "PropertyHandle.h"
+#include "PropertyHistoryReplay.h"
+#include "PropertyHistorySharedCache.h"
+#include "PropertyHistoryRevisionData.h"
+#include "PropertyHistoryGitLfs.h"
+#include "ISourceControlRevision.h"
+#include "PropertyHistoryUtilities.h"
+#include "Algo/Reverse.h"
+#include "Async/Async.h"
+
+bool FPropertyHistoryValuePath::Initialize(const IPropertyHandle& Handle)
+{
+	TSharedPtr<const IPropertyHandle> CurrentHandle = Handle.AsShared();
+	while (CurrentHandle)
+	{
+		const FProperty* Property = CurrentHandle->GetProperty();
+		if (!Property)
+		{
+			return false;
+		}
+
+		const int32 Index = CurrentHandle->GetIndexInArray();
+		if (Index == INDEX_NONE &&
+			Property->GetOwner<UClass>())
+		{
+			PropertyName = Property->GetFName();
+			Algo::Reverse(Children);
+
+			Key = PropertyName.ToString();
+			for (const TPair<FName, int32>& Child : Children)
+			{
+				Key += Child.Key.IsNone()
+					? "[" + FString::FromInt(Child.Value) + "]"
+					: "." + Child.Key.ToString();
+			}
+			return true;
+		}
+
+		// Same lookup as the hash tree: container elements by index, struct fields by name
+		if (Index != INDEX_NONE)
+		{
+			Children.Add({ NAME_None, Index });
+		}
+		else
+		{
+			Children.Add({ Property->GetFName(), INDEX_NONE });
+		}
+
+		CurrentHandle = CurrentHandle->GetParentHandle();
+	}
+
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+namespace PropertyHistoryChangeIndex
+{
+	TMap<TWeakObjectPtr<const UObject>, TWeakPtr<FPropertyHistoryChangeIndex>> Indices;
+}
+
+TSharedPtr<FPropertyHistoryChangeIndex> FPropertyHistoryChangeIndex::FindOrAdd(const UObject& Object)
+{
+	using namespace PropertyHistoryChangeIndex;
+	check(IsInGameThread());
+
+	for (auto It = Indices.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid() ||
+			!It.Value().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	if (const TSharedPtr<FPropertyHistoryChangeIndex> Index = Indices.FindRef(&Object).Pin())
+	{
+		return Index;
+	}
+
+	const TSharedRef<FPropertyHistoryChangeIndex> Index = MakeShared<FPropertyHistoryChangeIndex>();
+	if (!Index->Initialize(Object))
+	{
+		return nullptr;
+	}
+
+	Indices.Add(&Object, Index);
+	return Index;
+}
+
+FPropertyHistoryChangeIndex::~FPropertyHistoryChangeIndex()
+{
+	*CancellationToken = true;
+}
+
+TSharedPtr<ISourceControlRevision> FPropertyHistoryChangeIndex::FindLastChange(const FPropertyHistoryValuePath& Path)
+{
+	if (!TrackedProperties.Contains(Path.PropertyName))
+	{
+		TrackedProperties.Add(Path.PropertyName);
+		RequestProcess();
+		return nullptr;
+	}
+
+	TMap<FString, TSharedPtr<ISourceControlRevision>>& PathToLastChange = PropertyToPathToLastChange.FindOrAdd(Path.PropertyName);
+	if (const TSharedPtr<ISourceControlRevision>* LastChange = PathToLastChange.Find(Path.Key))
+	{
+		return *LastChange;
+	}
+
+	TSharedPtr<ISourceControlRevision> LastChange = INLINE_LAMBDA -> TSharedPtr<ISourceControlRevision>
+	{
+		TOptional<uint64> NewerHash;
+		TSharedPtr<ISourceControlRevision> NewerRevision;
+
+		for (const TSharedRef<FPropertyHistoryRevision>& Revision : Streams->GetRevisions())
+		{
+			const FRevisionValues* Values = RevisionIdToValues.Find(Revision->Id);
+			if (!Values ||
+				!Values->PropertyToHashTree.Contains(Path.PropertyName))
+			{
+				if (Revision->bLoadFailed)
+				{
+					// Failed to load, error is reported by the stream
+					continue;
+				}
+
+				// Not loaded or not processed yet: an older change might still be hidden behind this revision
+				return nullptr;
+			}
+
+			const TOptional<uint64> Hash = FindHash(*Values, Path);
+			if (!NewerRevision)
+			{
+				if (!Hash.IsSet())
+				{
+					// Value was added locally
+					return nullptr;
+				}
+
+				NewerHash = Hash;
+				NewerRevision = Revision->Revision;
+				continue;
+			}
+
+			if (Hash != NewerHash)
+			{
+				return NewerRevision;
+			}
+
+			NewerRevision = Revision->Revision;
+		}
+
+		if (Streams->IsLoading())
+		{
+			return nullptr;
+		}
+
+		// Never changed since it was added
+		return NewerRevision;
+	};
+
+	PathToLastChange.Add(Path.Key, LastChange);
+	return LastChange;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+bool FPropertyHistoryChangeIndex::Initialize(const UObject& Object)
+{
+	if (!FPropertyHistoryReplay::IsSourceControlEnabled())
+	{
+		return false;
+	}
+
+	if (!ObjectPath.Initialize(Object))
+	{
+		return false;
+	}
+
+	// Replayed revisions never go through the shared cache, neither do their hash trees
+	if (FPropertyHistoryReplaySettings::Get().Mode != EPropertyHistoryReplayMode::Replay)
+	{
+		SharedCacheDirectory = FPropertyHistorySharedCache::GetDirectory();
+	}
+	ObjectPathName = Object.GetPathName();
+
+	Streams = MakeShared<FPropertyHistoryObjectStreams>(ObjectPath);
+	Streams->OnUpdated.AddSP(this, &FPropertyHistoryChangeIndex::RequestProcess);
+	Streams->OnStateChanged.AddSP(this, &FPropertyHistoryChangeIndex::RequestProcess);
+	Streams->Subscribe(EPropertyHistoryPriority::Indexing);
+
+	return true;
+}
+
+void FPropertyHistoryChangeIndex::RequestProcess()
+{
+	if (bProcessRequested)
+	{
+		return;
+	}
+	bProcessRequested = true;
+
+	// Batch all the updates of a frame, and never hash from within a details panel paint
+	// Hashing is game thread work like loads, and shares their frame budget
+	FPropertyHistoryScheduler::Get().Request(
+		EPropertyHistoryStage::Load,
+		[] { return EPropertyHistoryPriority::Indexing; },
+		CancellationToken,
+		MakeWeakPtrLambda(this, [this](const FPropertyHistoryTask& Task)
+		{
+			bProcessRequested = false;
+			ProcessStreams();
+			FPropertyHistoryScheduler::Get().Finish(Task);
+		}));
+}
+
+void FPropertyHistoryChangeIndex::ProcessStreams()
+{
+	check(IsInGameThread());
+
+	TArray<TPair<int32, bool>> NewProcessedRevisions;
+	TSet<FName> HashedProperties;
+
+	for (const TSharedRef<FPropertyHistoryRevision>& Revision : Streams->GetRevisions())
+	{
+		NewProcessedRevisions.Add({ Revision->Id, Revision->bLoadFailed });
+
+		if (!Revision->bLoaded)
+		{
+			// Someone in the team might already have hashed it
+			LookupSharedCache(*Revision);
+			continue;
+		}
+
+		if (Revision->bLoadFailed)
+		{
+			continue;
+		}
+
+		FRevisionValues& Values = RevisionIdToValues.FindOrAdd(Revision->Id);
+
+		// Only properties shown in a details panel are hashed, new ones are caught up here
+		TArray<FName> PropertiesToHash;
+		for (const FName PropertyName : TrackedProperties)
+		{
+			if (!Values.PropertyToHashTree.Contains(PropertyName))
+			{
+				PropertiesToHash.Add(PropertyName);
+			}
+		}
+
+		if (PropertiesToHash.Num() > 0 &&
+			!Revision->Package)
+		{
+			// Unloaded before these properties were shown
+			Streams->RequestReload(Revision);
+		}
+		else if (PropertiesToHash.Num() > 0)
+		{
+			HashProperties(*Revision, PropertiesToHash, Values);
+			HashedProperties.Append(PropertiesToHash);
+		}
+
+		ShareHashTrees(Revision, Values);
+	}
+
+	if (NewProcessedRevisions != ProcessedRevisions ||
+		Streams->IsLoading() != bProcessedWhileLoading)
+	{
+		ProcessedRevisions = MoveTemp(NewProcessedRevisions);
+		bProcessedWhileLoading = Streams->IsLoading();
+		PropertyToPathToLastChange.Reset();
+		return;
+	}
+
+	for (const FName PropertyName : HashedProperties)
+	{
+		PropertyToPathToLastChange.Remove(PropertyName);
+	}
+}
+
+void FPropertyHistoryChangeIndex::HashProperties(const FPropertyHistoryRevision& Revision, const TConstArrayView<FName> PropertyNames, FRevisionValues& Values) const
+{
+	// Null if the object could not be found in that revision: all its properties are missing
+	UObject* Object = ObjectPath.Resolve(Revision);
+
+	for (const FName PropertyName : PropertyNames)
+	{
+		TSharedPtr<const FPropertyHistoryHashNode> HashTree;
+		if (const FProperty* Property = Object ? FindFProperty<FProperty>(Object->GetClass(), PropertyName) : nullptr)
+		{
+			HashTree = MakeShared<FPropertyHistoryHashNode>(FPropertyHistoryHashNode::Build(*Property, Property->ContainerPtrToValuePtr<void>(Object)));
+		}
+		Values.PropertyToHashTree.Add(PropertyName, HashTree);
+	}
+}
+
+void FPropertyHistoryChangeIndex::LookupSharedCache(const FPropertyHistoryRevision& Revision)
+{
+	if (SharedCacheDirectory.IsEmpty())
+	{
+		return;
+	}
+
+	TArray<TPair<FName, FString>> PropertyToValueKey;
+	for (const FName PropertyName : TrackedProperties)
+	{
+		bool bAlreadyLookedUp = false;
+		SharedCacheLookups.Add({ Revision.Id, PropertyName }, &bAlreadyLookedUp);
+
+		if (!bAlreadyLookedUp)
+		{
+			PropertyToValueKey.Add({ PropertyName, FPropertyHistorySharedCache::GetValueKey(ObjectPathName, PropertyName) });
+		}
+	}
+
+	if (PropertyToValueKey.Num() == 0)
+	{
+		return;
+	}
+
+	// Reading from the shared cache is like fetching a revision, possibly over the network
+	FPropertyHistoryScheduler::Get().Request(
+		EPropertyHistoryStage::Fetch,
+		[] { return EPropertyHistoryPriority::Indexing; },
+		CancellationToken,
+		MakeWeakPtrLambda(this, [this, RevisionId = Revision.Id, PackageFilename = Revision.PackageFilename, SourceControlRevision = Revision.Revision.ToSharedRef(), PropertyToValueKey = MoveTemp(PropertyToValueKey)](const FPropertyHistoryTask& Task)
+		{
+			Async(EAsyncExecution::ThreadPool, [Task, Directory = SharedCacheDirectory, RevisionId, PackageFilename, SourceControlRevision, PropertyToValueKey, Token = CancellationToken, WeakThis = AsWeak()]
+			{
+				TArray<TPair<FName, TSharedPtr<const FPropertyHistoryHashNode>>> PropertyToHashTree;
+				if (!*Token)
+				{
+					const FString ContentHash = FPropertyHistorySharedCache::FindContentHash(Directory, PackageFilename, *SourceControlRevision);
+					if (!ContentHash.IsEmpty())
+					{
+						for (const TPair<FName, FString>& It : PropertyToValueKey)
+						{
+							if (const TOptional<TSharedPtr<const FPropertyHistoryHashNode>> HashTree = FPropertyHistorySharedCache::FindHashTree(Directory, ContentHash, It.Value))
+							{
+								PropertyToHashTree.Add({ It.Key, HashTree.GetValue() });
+							}
+						}
+					}
+				}
+
+				AsyncTask(ENamedThreads::GameThread, [Task, RevisionId, PropertyToHashTree = MoveTemp(PropertyToHashTree), Token, WeakThis]
+				{
+					FPropertyHistoryScheduler::Get().Finish(Task);
+
+					const TSharedPtr<FPropertyHistoryChangeIndex> This = WeakThis.Pin();
+					if (!This ||
+						*Token ||
+						PropertyToHashTree.Num() == 0)
+					{
+						return;
+					}
+
+					FRevisionValues& Values = This->RevisionIdToValues.FindOrAdd(RevisionId);
+					for (const TPair<FName, TSharedPtr<const FPropertyHistoryHashNode>>& It : PropertyToHashTree)
+					{
+						// Hashing the loaded revision gives the same tree
+						if (!Values.PropertyToHashTree.Contains(It.Key))
+						{
+							Values.PropertyToHashTree.Add(It.Key, It.Value);
+						}
+						Values.SharedProperties.Add(It.Key);
+
+						This->PropertyToPathToLastChange.Remove(It.Key);
+					}
+				});
+			});
+		}));
+}
+
+void FPropertyHistoryChangeIndex::ShareHashTrees(const TSharedRef<FPropertyHistoryRevision>& Revision, FRevisionValues& Values)
+{
+	if (SharedCacheDirectory.IsEmpty())
+	{
+		return;
+	}
+
+	TArray<TPair<FString, TSharedPtr<const FPropertyHistoryHashNode>>> ValueKeyToHashTree;
+	for (const TPair<FName, TSharedPtr<const FPropertyHistoryHashNode>>& It : Values.PropertyToHashTree)
+	{
+		bool bAlreadyShared = false;
+		Values.SharedProperties.Add(It.Key, &bAlreadyShared);
+
+		if (!bAlreadyShared)
+		{
+			ValueKeyToHashTree.Add({ FPropertyHistorySharedCache::GetValueKey(ObjectPathName, It.Key), It.Value });
+		}
+	}
+
+	if (ValueKeyToHashTree.Num() == 0)
+	{
+		return;
+	}
+
+	Async(EAsyncExecution::ThreadPool, [Directory = SharedCacheDirectory, ContentHash = Revision->ContentHash, SourceControlRevision = Revision->Revision.ToSharedRef(), PackageFilename = Revision->PackageFilename, CacheDirectory = FPropertyHistoryRevisionData::GetCacheDirectory(), GitLfs = FPropertyHistoryGitLfs::Get(), ValueKeyToHashTree = MoveTemp(ValueKeyToHashTree), WeakRevision = TWeakPtr<FPropertyHistoryRevision>(Revision)]
+	{
+		FString SharedContentHash = ContentHash;
+		if (SharedContentHash.IsEmpty())
+		{
+			// Revisions found locally are only hashed & added to the shared cache once something of them is shared
+			if (const TSharedPtr<FPropertyHistoryRevisionData> Data = FPropertyHistoryRevisionData::FindLocal(PackageFilename, *SourceControlRevision, CacheDirectory, GitLfs))
+			{
+				SharedContentHash = FPropertyHistorySharedCache::FindOrAddRevision(Directory, PackageFilename, *SourceControlRevision, Data->GetView());
+			}
+
+			if (SharedContentHash.IsEmpty())
+			{
+				return;
+			}
+
+			AsyncTask(ENamedThreads::GameThread, [WeakRevision, SharedContentHash]
+			{
+				if (const TSharedPtr<FPropertyHistoryRevision> Revision = WeakRevision.Pin())
+				{
+					Revision->ContentHash = SharedContentHash;
+				}
+			});
+		}
+
+		for (const TPair<FString, TSharedPtr<const FPropertyHistoryHashNode>>& It : ValueKeyToHashTree)
+		{
+			FPropertyHistorySharedCache::AddHashTree(Directory, SharedContentHash, It.Key, It.Value.Get());
+		}
+	});
+}
+
+TOptional<uint64> FPropertyHistoryChangeIndex::FindHash(const FRevisionValues& Values, const FPropertyHistoryValuePath& Path)
+{
+	const TSharedPtr<const FPropertyHistoryHashNode> HashTree = Values.PropertyToHashTree.FindRef(Path.PropertyName);
+	if (!HashTree)
+	{
+		return {};
+	}
+
+	const FPropertyHistoryHashNode* Node = HashTree.Get();
+	for (const TPair<FName, int32>& Child : Path.Children)
+	{
+		Node = Child.Key.IsNone()
+			? Node->FindChild(Child.Value)
+			: Node->FindChild(Child.Key);
+
+		if (!Node)
+		{
+			return {};
+		}
+	}
+
+	return Node->Hash;
+}
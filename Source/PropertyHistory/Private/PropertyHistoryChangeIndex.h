@@ -0,0 +1,79 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PropertyHistoryHashTree.h"
+#include "PropertyHistoryObjectPath.h"
+#include "PropertyHistoryObjectStreams.h"
+
+class IPropertyHandle;
+class ISourceControlRevision;
+
+// Path from a property of an object to one of its nested values, eg Struct.Array[2]
+struct FPropertyHistoryValuePath
+{
+	FName PropertyName;
+	// Struct field name, or container index if none
+	TArray<TPair<FName, int32>> Children;
+	// eg Struct.Array[2], used to cache lookups
+	FString Key;
+
+	// False if the handle is not a property of the object it is shown for, eg a customized row
+	bool Initialize(const IPropertyHandle& Handle);
+};
+
+// Last change of every value of an object that is shown in a details panel
+// Revisions are hashed as they are streamed in, nothing is ever computed when the details panel asks
+class FPropertyHistoryChangeIndex : public TSharedFromThis<FPropertyHistoryChangeIndex>
+{
+public:
+	// Null if the object is not in source control
+	static TSharedPtr<FPropertyHistoryChangeIndex> FindOrAdd(const UObject& Object);
+
+	FPropertyHistoryChangeIndex() = default;
+	~FPropertyHistoryChangeIndex();
+
+	// Null until known. Unknown values are tracked from now on
+	TSharedPtr<ISourceControlRevision> FindLastChange(const FPropertyHistoryValuePath& Path);
+
+private:
+	struct FRevisionValues
+	{
+		// Null if the property or the object does not exist in that revision
+		// Also filled from the shared cache before the revision is loaded
+		TMap<FName, TSharedPtr<const FPropertyHistoryHashNode>> PropertyToHashTree;
+		// Properties whose hash tree is already in the shared cache, read from it or written to it
+		TSet<FName> SharedProperties;
+	};
+
+	FPropertyHistoryObjectPath ObjectPath;
+	TSharedPtr<FPropertyHistoryObjectStreams> Streams;
+
+	// Empty if there is no shared cache
+	FString SharedCacheDirectory;
+	FString ObjectPathName;
+	// Revisions & properties already looked up in the shared cache, found or not
+	TSet<TPair<int32, FName>> SharedCacheLookups;
+
+	TSet<FName> TrackedProperties;
+	TMap<int32, FRevisionValues> RevisionIdToValues;
+
+	// Asked for on every paint: only the paths of properties with new hash trees are found again
+	TMap<FName, TMap<FString, TSharedPtr<ISourceControlRevision>>> PropertyToPathToLastChange;
+	// Revision ids & whether they failed to load, as of the last process: any change invalidates every path
+	TArray<TPair<int32, bool>> ProcessedRevisions;
+	bool bProcessedWhileLoading = false;
+
+	bool bProcessRequested = false;
+	const TSharedRef<FThreadSafeBool> CancellationToken = MakeShared<FThreadSafeBool>(false);
+
+	bool Initialize(const UObject& Object);
+	void RequestProcess();
+	void ProcessStreams();
+	void HashProperties(const FPropertyHistoryRevision& Revision, TConstArrayView<FName> PropertyNames, FRevisionValues& Values) const;
+	void LookupSharedCache(const FPropertyHistoryRevision& Revision);
+	void ShareHashTrees(const TSharedRef<FPropertyHistoryRevision>& Revision, FRevisionValues& Values);
+
+	static TOptional<uint64> FindHash(const FRevisionValues& Values, const FPropertyHistoryValuePath& Path);
+};
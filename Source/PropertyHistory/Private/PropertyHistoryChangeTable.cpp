@@ -0,0 +1,210 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryChangeTable.h"
+#include "SPropertyHistoryChangeTable.h"
+#include "PropertyHistoryReplay.h"
+#include "ISourceControlRevision.h"
+#include "PropertyHistoryUtilities.h"
+
+bool FPropertyHistoryChangeTable::Initialize(const UObject& Object)
+{
+	if (!FPropertyHistoryReplay::IsSourceControlEnabled())
+	{
+		return false;
+	}
+
+	if (!ObjectPath.Initialize(Object))
+	{
+		return false;
+	}
+
+	ObjectName = Object.GetName();
+
+	Streams = MakeShared<FPropertyHistoryObjectStreams>(ObjectPath);
+	Streams->OnUpdated.AddSP(this, &FPropertyHistoryChangeTable::ProcessStreams);
+	Streams->OnStateChanged.AddSPLambda(this, [this]
+	{
+		OnStateChanged.Broadcast();
+	});
+
+	return true;
+}
+
+void FPropertyHistoryChangeTable::ShowHistory()
+{
+	const TSharedPtr<SDockTab> NewTab = FGlobalTabmanager::Get()->TryInvokeTab(FName("PropertyHistoryChangesTab"));
+	if (!ensure(NewTab))
+	{
+		return;
+	}
+
+	NewTab->SetLabel(GetTitle());
+
+	const TSharedRef<SPropertyHistoryChangeTable> ChangeTableWidget = StaticCastSharedRef<SPropertyHistoryChangeTable>(NewTab->GetContent());
+	ChangeTableWidget->SetTable(AsShared());
+
+	FSlateApplication::Get().SetKeyboardFocus(ChangeTableWidget, EFocusCause::SetDirectly);
+
+	if (Streams->IsSubscribed())
+	{
+		return;
+	}
+	Streams->Subscribe();
+
+	ProcessStreams();
+}
+
+void FPropertyHistoryChangeTable::Cancel()
+{
+	Streams->Unsubscribe();
+}
+
+void FPropertyHistoryChangeTable::MakePriority() const
+{
+	Streams->MakePriority();
+}
+
+bool FPropertyHistoryChangeTable::IsLoading() const
+{
+	if (Error.IsSet())
+	{
+		return false;
+	}
+
+	return Streams->IsLoading();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FPropertyHistoryChangeTable::ProcessStreams()
+{
+	for (const FString& StreamError : Streams->ConsumeErrors())
+	{
+		AddError(StreamError);
+	}
+
+	const TArray<TSharedRef<FPropertyHistoryRevision>> Revisions = Streams->GetRevisions();
+	for (const TSharedRef<FPropertyHistoryRevision>& Revision : Revisions)
+	{
+		if (!Revision->bLoaded ||
+			RevisionIdToValues.Contains(Revision->Id))
+		{
+			continue;
+		}
+
+		if (!Revision->Package &&
+			!Revision->bLoadFailed)
+		{
+			// Unloaded before we were opened
+			Streams->RequestReload(Revision);
+			continue;
+		}
+
+		if (Revision->bLoadFailed)
+		{
+			// Failed to fetch or load, error is reported by the stream
+			// Skipped like the handlers do: diffing it as empty would show everything as removed then added back
+			continue;
+		}
+
+		// Null if the object could not be found in that revision: all its values are missing
+		TSharedPtr<TMap<FString, FValue>> Values;
+		if (UObject* Object = ObjectPath.Resolve(*Revision))
+		{
+			Values = MakeShared<TMap<FString, FValue>>();
+			if (!ExtractValues(*Object, *Values))
+			{
+				Values.Reset();
+			}
+		}
+
+		RevisionIdToValues.Add(Revision->Id, Values);
+	}
+
+	RebuildChanges(Revisions);
+}
+
+void FPropertyHistoryChangeTable::RebuildChanges(const TArray<TSharedRef<FPropertyHistoryRevision>>& Revisions)
+{
+	const TMap<FString, FValue> EmptyValues;
+	const TMap<FString, FValue>* PreviousValues = &EmptyValues;
+
+	// Oldest revision first, each revision is only diffed against the previous loaded one
+	TArray<TArray<TSharedPtr<FPropertyHistoryChange>>> RevisionsChanges;
+	for (const TSharedRef<FPropertyHistoryRevision>& Revision : ReverseIterate(Revisions))
+	{
+		const TSharedPtr<const TMap<FString, FValue>>* ValuesPtr = RevisionIdToValues.Find(Revision->Id);
+		if (!ValuesPtr)
+		{
+			// Not loaded yet, or failed to
+			continue;
+		}
+
+		const TMap<FString, FValue>& Values = *ValuesPtr ? **ValuesPtr : EmptyValues;
+
+		TArray<TSharedPtr<FPropertyHistoryChange>>& RevisionChanges = RevisionsChanges.Emplace_GetRef();
+		for (const auto& It : Values)
+		{
+			const FValue* OldValue = PreviousValues->Find(It.Key);
+			if (OldValue &&
+				OldValue->Value == It.Value.Value)
+			{
+				continue;
+			}
+
+			RevisionChanges.Add(MakeSharedCopy(FPropertyHistoryChange
+			{
+				Revision->Revision,
+				It.Value.Name,
+				OldValue ? TOptional<FString>(OldValue->Value) : TOptional<FString>(),
+				It.Value.Value
+			}));
+		}
+		for (const auto& It : *PreviousValues)
+		{
+			if (Values.Contains(It.Key))
+			{
+				continue;
+			}
+
+			RevisionChanges.Add(MakeSharedCopy(FPropertyHistoryChange
+			{
+				Revision->Revision,
+				It.Value.Name,
+				It.Value.Value,
+				{}
+			}));
+		}
+
+		RevisionChanges.Sort([](const TSharedPtr<FPropertyHistoryChange>& A, const TSharedPtr<FPropertyHistoryChange>& B)
+		{
+			return A->Name < B->Name;
+		});
+
+		PreviousValues = &Values;
+	}
+
+	Changes.Reset();
+	for (const TArray<TSharedPtr<FPropertyHistoryChange>>& RevisionChanges : ReverseIterate(RevisionsChanges))
+	{
+		Changes.Append(RevisionChanges);
+	}
+
+	OnChangesUpdated.Broadcast();
+}
+
+void FPropertyHistoryChangeTable::AddError(const FString& NewError)
+{
+	if (Error.IsSet())
+	{
+		Error.GetValue() += "\n" + NewError;
+	}
+	else
+	{
+		Error = NewError;
+	}
+
+	OnStateChanged.Broadcast();
+}
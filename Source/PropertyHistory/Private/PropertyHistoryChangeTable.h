@@ -0,0 +1,75 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PropertyHistoryObjectPath.h"
+#include "PropertyHistoryObjectStreams.h"
+
+struct FPropertyHistoryChange
+{
+	TSharedPtr<ISourceControlRevision> Revision;
+	FString Name;
+	// Unset if the value was added in this revision
+	TOptional<FString> OldValue;
+	// Unset if the value was removed in this revision
+	TOptional<FString> NewValue;
+};
+
+// Every change of a set of values of an object, in a single pass over its revisions
+// Subclasses pick the values, eg all the parameters of a material instance
+class FPropertyHistoryChangeTable : public TSharedFromThis<FPropertyHistoryChangeTable>
+{
+public:
+	FSimpleMulticastDelegate OnChangesUpdated;
+	FSimpleMulticastDelegate OnStateChanged;
+	// Newest revision first
+	TArray<TSharedPtr<FPropertyHistoryChange>> Changes;
+
+public:
+	FPropertyHistoryChangeTable() = default;
+	virtual ~FPropertyHistoryChangeTable() = default;
+
+	bool Initialize(const UObject& Object);
+	void ShowHistory();
+	void Cancel();
+	void MakePriority() const;
+
+	bool IsLoading() const;
+
+	const TOptional<FString>& GetError() const
+	{
+		return Error;
+	}
+
+	virtual FText GetTitle() const = 0;
+
+protected:
+	struct FValue
+	{
+		FString Name;
+		FString Value;
+	};
+
+	// Keys must be stable across revisions, names are only displayed
+	virtual bool ExtractValues(UObject& Object, TMap<FString, FValue>& OutValues) const = 0;
+
+	const FString& GetObjectName() const
+	{
+		return ObjectName;
+	}
+
+private:
+	FPropertyHistoryObjectPath ObjectPath;
+	FString ObjectName;
+	TSharedPtr<FPropertyHistoryObjectStreams> Streams;
+
+	// Null if the object could not be found in that revision
+	TMap<int32, TSharedPtr<const TMap<FString, FValue>>> RevisionIdToValues;
+
+	TOptional<FString> Error;
+
+	void ProcessStreams();
+	void RebuildChanges(const TArray<TSharedRef<FPropertyHistoryRevision>>& Revisions);
+	void AddError(const FString& NewError);
+};
@@ -0,0 +1,287 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryCommandlet.h"
+#include "ISourceControlModule.h"
+#include "ISourceControlRevision.h"
+#include "SourceControlOperations.h"
+#include "Misc/PackageName.h"
+#include "PropertyHistoryGitLfs.h"
+#include "PropertyHistoryHashTree.h"
+#include "PropertyHistoryReplay.h"
+#include "PropertyHistoryRevisionData.h"
+#include "PropertyHistorySharedCache.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogPropertyHistoryCommandlet, Log, All);
+
+UPropertyHistoryCommandlet::UPropertyHistoryCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UPropertyHistoryCommandlet::Main(const FString& Params)
+{
+	if (FParse::Param(*Params, TEXT("CheckGitLfs")))
+	{
+		return CheckGitLfs(Params);
+	}
+
+	const FString SharedCacheDirectory = FPropertyHistorySharedCache::GetDirectory();
+	if (SharedCacheDirectory.IsEmpty())
+	{
+		UE_LOG(LogPropertyHistoryCommandlet, Error, TEXT("No shared cache: set [PropertyHistory] SharedCacheDirectory or pass -PropertyHistorySharedCache="));
+		return 1;
+	}
+
+	const TArray<FString> PackageFilenames = GetPackageFilenames(Params);
+	if (PackageFilenames.Num() == 0)
+	{
+		UE_LOG(LogPropertyHistoryCommandlet, Error, TEXT("No packages: pass -Packages=/Game/A,/Game/B or -PackageList=File.txt"));
+		return 1;
+	}
+
+	int32 MaxRevisions = 0;
+	FParse::Value(*Params, TEXT("MaxRevisions="), MaxRevisions);
+
+	ISourceControlProvider& SourceControlProvider = ISourceControlModule::Get().GetProvider();
+	SourceControlProvider.Init(true);
+
+	if (!SourceControlProvider.IsAvailable())
+	{
+		UE_LOG(LogPropertyHistoryCommandlet, Error, TEXT("Source control is not available"));
+		return 1;
+	}
+
+	// Query all histories at once, providers batch them
+	const TSharedRef<FUpdateStatus> UpdateStatusOperation = ISourceControlOperation::Create<FUpdateStatus>();
+	UpdateStatusOperation->SetUpdateHistory(true);
+
+	if (SourceControlProvider.Execute(UpdateStatusOperation, PackageFilenames, EConcurrency::Synchronous) != ECommandResult::Succeeded)
+	{
+		UE_LOG(LogPropertyHistoryCommandlet, Error, TEXT("Failed to update status"));
+		return 1;
+	}
+
+	const FPropertyHistoryGitLfs GitLfs = FPropertyHistoryGitLfs::Get();
+
+	int32 NumErrors = 0;
+	for (const FString& PackageFilename : PackageFilenames)
+	{
+		const FSourceControlStatePtr State = SourceControlProvider.GetState(PackageFilename, EStateCacheUsage::Use);
+		if (!State)
+		{
+			UE_LOG(LogPropertyHistoryCommandlet, Error, TEXT("Failed to get source control state for %s"), *PackageFilename);
+			NumErrors++;
+			continue;
+		}
+
+		FString PackageName;
+		ensure(FPackageName::TryConvertFilenameToLongPackageName(PackageFilename, PackageName));
+
+		const int32 NumRevisions = MaxRevisions > 0 ? FMath::Min(State->GetHistorySize(), MaxRevisions) : State->GetHistorySize();
+		UE_LOG(LogPropertyHistoryCommandlet, Display, TEXT("%s: %d revisions"), *PackageName, NumRevisions);
+
+		// One Git LFS download for the whole history
+		TArray<FString> Revisions;
+		for (int32 HistoryIndex = 0; HistoryIndex < NumRevisions; HistoryIndex++)
+		{
+			if (const TSharedPtr<ISourceControlRevision> Revision = State->GetHistoryItem(HistoryIndex))
+			{
+				Revisions.Add(Revision->GetRevision());
+			}
+		}
+		for (const TArray<FString>& Batch : FPropertyHistoryGitLfs::MakePrefetchBatches(Revisions))
+		{
+			GitLfs.Prefetch(PackageFilename, Batch);
+		}
+
+		for (int32 HistoryIndex = 0; HistoryIndex < NumRevisions; HistoryIndex++)
+		{
+			const TSharedPtr<ISourceControlRevision> Revision = State->GetHistoryItem(HistoryIndex);
+			if (!Revision)
+			{
+				NumErrors++;
+				continue;
+			}
+
+			// No local cache: the build machine only fills the shared one
+			const TSharedPtr<FPropertyHistoryRevisionData> Data = FPropertyHistoryRevisionData::Fetch(
+				PackageFilename,
+				*Revision,
+				{},
+				SharedCacheDirectory,
+				GitLfs,
+				FPropertyHistoryReplaySettings());
+
+			// Revisions read from the local Git LFS store are not added by Fetch
+			if (Data &&
+				Data->ContentHash.IsEmpty())
+			{
+				Data->ContentHash = FPropertyHistorySharedCache::FindOrAddRevision(SharedCacheDirectory, PackageFilename, *Revision, Data->GetView());
+			}
+
+			if (!Data ||
+				Data->ContentHash.IsEmpty())
+			{
+				UE_LOG(LogPropertyHistoryCommandlet, Error, TEXT("Failed to fetch revision %s of %s"), *Revision->GetRevision(), *PackageName);
+				NumErrors++;
+				continue;
+			}
+
+			const UPackage* Package = Data->LoadPackage(PackageFilename, *Revision);
+			if (!Package)
+			{
+				UE_LOG(LogPropertyHistoryCommandlet, Error, TEXT("Failed to load revision %s of %s"), *Revision->GetRevision(), *PackageName);
+				NumErrors++;
+				continue;
+			}
+
+			IndexRevision(PackageName, *Package, SharedCacheDirectory, Data->ContentHash);
+
+			// Revision packages are not rooted
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		}
+	}
+
+	UE_LOG(LogPropertyHistoryCommandlet, Display, TEXT("Populated %s with %d packages, %d errors"), *SharedCacheDirectory, PackageFilenames.Num(), NumErrors);
+	return NumErrors > 0 ? 1 : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+int32 UPropertyHistoryCommandlet::CheckGitLfs(const FString& Params)
+{
+	int32 NumErrors = 0;
+	const auto Check = [&](const bool bCondition, const TCHAR* What)
+	{
+		if (!bCondition)
+		{
+			UE_LOG(LogPropertyHistoryCommandlet, Error, TEXT("Check failed: %s"), What);
+			NumErrors++;
+		}
+	};
+
+	{
+		const FString Oid = "4d7a214614ab2935c943f9e0ff69d22eadbb8f32b1258daaa5e2ca24d17e2393";
+
+		const TOptional<FPropertyHistoryGitLfs::FPointer> Pointer = FPropertyHistoryGitLfs::ParsePointer(
+			"version https://git-lfs.github.com/spec/v1\noid sha256:" + Oid + "\nsize 12345\n");
+		Check(Pointer && Pointer->Oid == Oid && Pointer->Size == 12345, TEXT("ParsePointer reads a pointer"));
+
+		Check(FPropertyHistoryGitLfs::ParsePointer(
+			"version https://git-lfs.github.com/spec/v1\r\noid sha256:" + Oid + "\r\nsize 12345\r\n").IsSet(), TEXT("ParsePointer reads CRLF pointers"));
+		Check(!FPropertyHistoryGitLfs::ParsePointer(
+			"oid sha256:" + Oid + "\nsize 12345\n").IsSet(), TEXT("ParsePointer rejects pointers without version"));
+		Check(!FPropertyHistoryGitLfs::ParsePointer(
+			"version https://git-lfs.github.com/spec/v1\noid sha256:" + Oid.Left(63) + "\nsize 12345\n").IsSet(), TEXT("ParsePointer rejects short oids"));
+		Check(!FPropertyHistoryGitLfs::ParsePointer(
+			"version https://git-lfs.github.com/spec/v1\noid sha256:" + Oid.Left(63) + "g\nsize 12345\n").IsSet(), TEXT("ParsePointer rejects non hex oids"));
+		Check(!FPropertyHistoryGitLfs::ParsePointer(
+			"version https://git-lfs.github.com/spec/v1\noid sha256:" + Oid + "\n").IsSet(), TEXT("ParsePointer rejects pointers without size"));
+		Check(!FPropertyHistoryGitLfs::ParsePointer("").IsSet(), TEXT("ParsePointer rejects empty blobs"));
+	}
+
+	FString RepositoryDirectory;
+	FString File;
+	if (FParse::Value(*Params, TEXT("GitLfsRepository="), RepositoryDirectory) &&
+		FParse::Value(*Params, TEXT("GitLfsFile="), File))
+	{
+		const FPropertyHistoryGitLfs GitLfs = FPropertyHistoryGitLfs::Find(RepositoryDirectory);
+		Check(GitLfs.IsEnabled(), TEXT("GitLfsRepository is in a Git repository"));
+
+		const FString Filename = GitLfs.RepositoryDirectory / File;
+
+		FString Log;
+		Check(GitLfs.RunGit("log --format=%H -- \"" + File + "\"", Log), TEXT("GitLfsFile has a history"));
+
+		TArray<FString> Revisions;
+		Log.ParseIntoArrayLines(Revisions);
+		Check(Revisions.Num() > 0, TEXT("GitLfsFile has revisions"));
+
+		for (const FString& Revision : Revisions)
+		{
+			Check(GitLfs.FindObjectPath(Filename, Revision).IsEmpty(), *("Object of " + Revision + " is only in the remote before Prefetch"));
+		}
+
+		for (const TArray<FString>& Batch : FPropertyHistoryGitLfs::MakePrefetchBatches(Revisions))
+		{
+			GitLfs.Prefetch(Filename, Batch);
+		}
+
+		for (const FString& Revision : Revisions)
+		{
+			const FString ObjectPath = GitLfs.FindObjectPath(Filename, Revision);
+			Check(!ObjectPath.IsEmpty(), *("Object of " + Revision + " is found after Prefetch"));
+			Check(ObjectPath.IsEmpty() || GitLfs.Fetch(Filename, Revision).IsValid(), *("Object of " + Revision + " is read after Prefetch"));
+		}
+
+		UE_LOG(LogPropertyHistoryCommandlet, Display, TEXT("Checked %d revisions of %s"), Revisions.Num(), *Filename);
+	}
+
+	UE_LOG(LogPropertyHistoryCommandlet, Display, TEXT("Git LFS checks done, %d errors"), NumErrors);
+	return NumErrors > 0 ? 1 : 0;
+}
+
+TArray<FString> UPropertyHistoryCommandlet::GetPackageFilenames(const FString& Params)
+{
+	TArray<FString> PackageNames;
+
+	FString Packages;
+	if (FParse::Value(*Params, TEXT("Packages="), Packages, false))
+	{
+		Packages.ParseIntoArray(PackageNames, TEXT(","));
+	}
+
+	FString PackageList;
+	if (FParse::Value(*Params, TEXT("PackageList="), PackageList))
+	{
+		TArray<FString> Lines;
+		FFileHelper::LoadFileToStringArray(Lines, *PackageList);
+
+		for (const FString& Line : Lines)
+		{
+			if (!Line.TrimStartAndEnd().IsEmpty())
+			{
+				PackageNames.Add(Line.TrimStartAndEnd());
+			}
+		}
+	}
+
+	TArray<FString> PackageFilenames;
+	for (const FString& PackageName : PackageNames)
+	{
+		FPackagePath PackagePath;
+		if (!FPackageName::DoesPackageExist(PackageName, &PackagePath))
+		{
+			UE_LOG(LogPropertyHistoryCommandlet, Warning, TEXT("%s does not exist"), *PackageName);
+			continue;
+		}
+
+		PackageFilenames.AddUnique(FPaths::ConvertRelativePathToFull(PackagePath.GetLocalFullPath()));
+	}
+	return PackageFilenames;
+}
+
+void UPropertyHistoryCommandlet::IndexRevision(const FString& PackageName, const UPackage& Package, const FString& SharedCacheDirectory, const FString& ContentHash)
+{
+	// Same keys as the change index: top level objects by their path in the current package, eg the asset or a Blueprint class defaults
+	ForEachObjectWithOuter(&Package, [&](const UObject* Object)
+	{
+		const FString ObjectPathName = PackageName + "." + Object->GetName();
+
+		for (const FProperty* Property : TFieldRange<FProperty>(Object->GetClass()))
+		{
+			if (!Property->HasAnyPropertyFlags(CPF_Edit))
+			{
+				continue;
+			}
+
+			const FPropertyHistoryHashNode HashTree = FPropertyHistoryHashNode::Build(*Property, Property->ContainerPtrToValuePtr<void>(Object));
+			FPropertyHistorySharedCache::AddHashTree(SharedCacheDirectory, ContentHash, FPropertyHistorySharedCache::GetValueKey(ObjectPathName, Property->GetFName()), &HashTree);
+		}
+	}, false);
+}
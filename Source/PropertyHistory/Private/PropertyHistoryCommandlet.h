@@ -0,0 +1,31 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PropertyHistoryCommandlet.generated.h"
+
+// Pre-populates the shared cache, eg nightly on a build machine, so that editors never fetch nor hash the hot assets themselves
+// Every revision is fetched, and every editable property of the top level objects of the package is hashed
+// UnrealEditor-Cmd Project.uproject -run=PropertyHistory -Packages=/Game/A,/Game/B -PackageList=HotAssets.txt -MaxRevisions=50
+// -CheckGitLfs checks the Git LFS support instead, against a clone of a local bare remote made with GIT_LFS_SKIP_SMUDGE=1:
+// UnrealEditor-Cmd Project.uproject -run=PropertyHistory -CheckGitLfs -GitLfsRepository=D:/Clone -GitLfsFile=Content/A.uasset
+UCLASS()
+class UPropertyHistoryCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UPropertyHistoryCommandlet();
+
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+
+private:
+	// Returns the exit code
+	static int32 CheckGitLfs(const FString& Params);
+	static TArray<FString> GetPackageFilenames(const FString& Params);
+	static void IndexRevision(const FString& PackageName, const UPackage& Package, const FString& SharedCacheDirectory, const FString& ContentHash);
+};
@@ -0,0 +1,165 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryDataTableChanges.h"
+#include "Editor.h"
+#include "Engine/DataTable.h"
+#include "Subsystems/AssetEditorSubsystem.h"
+
+namespace PropertyHistoryDataTableChanges
+{
+	// Revisions are never modified once loaded, and are shared by all the histories of their package
+	TMap<TWeakObjectPtr<const UDataTable>, TSharedPtr<const FPropertyHistoryDataTableRevision>> Revisions;
+}
+
+TSharedRef<const FPropertyHistoryDataTableRevision> FPropertyHistoryDataTableRevision::FindOrDecode(const UDataTable& DataTable)
+{
+	using namespace PropertyHistoryDataTableChanges;
+	check(IsInGameThread());
+
+	if (const TSharedPtr<const FPropertyHistoryDataTableRevision> Revision = Revisions.FindRef(&DataTable))
+	{
+		return Revision.ToSharedRef();
+	}
+
+	for (auto It = Revisions.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	const TSharedRef<FPropertyHistoryDataTableRevision> Revision = MakeShared<FPropertyHistoryDataTableRevision>();
+	Revisions.Add(&DataTable, Revision);
+
+	const UScriptStruct* RowStruct = DataTable.GetRowStruct();
+	if (!RowStruct)
+	{
+		return Revision;
+	}
+
+	TArray<const FProperty*> Properties;
+	for (const FProperty* Property : TFieldRange<FProperty>(RowStruct))
+	{
+		Properties.Add(Property);
+		Revision->Columns.Add(Property->GetFName());
+		Revision->ColumnDisplayNames.Add(Property->GetDisplayNameText().ToString());
+	}
+
+	Revision->RowToValues.Reserve(DataTable.GetRowMap().Num());
+
+	for (const auto& It : DataTable.GetRowMap())
+	{
+		TArray<FString>& Values = Revision->RowToValues.Add(It.Key);
+		Values.Reserve(Properties.Num());
+
+		for (const FProperty* Property : Properties)
+		{
+			FString& Value = Values.Emplace_GetRef();
+			Property->ExportText_InContainer(0, Value, It.Value, It.Value, nullptr, PPF_None);
+		}
+	}
+
+	return Revision;
+}
+
+UDataTable* FPropertyHistoryDataTableRevision::FindEditedRow(const UScriptStruct& Struct, const void* RowData, FName& OutRowName)
+{
+	if (!GEditor)
+	{
+		return nullptr;
+	}
+
+	for (UObject* Asset : GEditor->GetEditorSubsystem<UAssetEditorSubsystem>()->GetAllEditedAssets())
+	{
+		UDataTable* DataTable = Cast<UDataTable>(Asset);
+		if (!DataTable ||
+			!DataTable->GetRowStruct() ||
+			!DataTable->GetRowStruct()->IsChildOf(&Struct))
+		{
+			continue;
+		}
+
+		for (const auto& It : DataTable->GetRowMap())
+		{
+			if (It.Value == RowData)
+			{
+				OutRowName = It.Key;
+				return DataTable;
+			}
+		}
+	}
+
+	return nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FText FPropertyHistoryDataTableRowChanges::GetTitle() const
+{
+	return FText::FromString(GetObjectName() + "." + RowName.ToString() + " History");
+}
+
+bool FPropertyHistoryDataTableRowChanges::ExtractValues(UObject& Object, TMap<FString, FValue>& OutValues) const
+{
+	const UDataTable* DataTable = Cast<UDataTable>(&Object);
+	if (!DataTable)
+	{
+		return false;
+	}
+
+	const TSharedRef<const FPropertyHistoryDataTableRevision> Revision = FPropertyHistoryDataTableRevision::FindOrDecode(*DataTable);
+
+	// No values if the row does not exist in this revision: its columns show as added or removed
+	const TArray<FString>* Values = Revision->RowToValues.Find(RowName);
+	if (!Values)
+	{
+		return true;
+	}
+
+	for (int32 Index = 0; Index < Revision->Columns.Num(); Index++)
+	{
+		// Row struct might differ between revisions, key by name
+		OutValues.Add(Revision->Columns[Index].ToString(), FValue{ Revision->ColumnDisplayNames[Index], (*Values)[Index] });
+	}
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FText FPropertyHistoryDataTableColumnChanges::GetTitle() const
+{
+	return FText::FromString(GetObjectName() + " " + ColumnName.ToString() + " History");
+}
+
+bool FPropertyHistoryDataTableColumnChanges::ExtractValues(UObject& Object, TMap<FString, FValue>& OutValues) const
+{
+	const UDataTable* DataTable = Cast<UDataTable>(&Object);
+	if (!DataTable)
+	{
+		return false;
+	}
+
+	const TSharedRef<const FPropertyHistoryDataTableRevision> Revision = FPropertyHistoryDataTableRevision::FindOrDecode(*DataTable);
+
+	const int32 ColumnIndex = Revision->Columns.IndexOfByKey(ColumnName);
+	if (ColumnIndex == INDEX_NONE)
+	{
+		return true;
+	}
+
+	OutValues.Reserve(Revision->RowToValues.Num());
+
+	for (const auto& It : Revision->RowToValues)
+	{
+		FString RowString = It.Key.ToString();
+		OutValues.Add(RowString, FValue{ RowString, It.Value[ColumnIndex] });
+	}
+
+	return true;
+}
@@ -0,0 +1,66 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PropertyHistoryChangeTable.h"
+
+class UDataTable;
+
+// One revision of a data table, decoded once and shared by every row & column history of it
+struct FPropertyHistoryDataTableRevision
+{
+	// Row struct properties, in struct order
+	TArray<FName> Columns;
+	TArray<FString> ColumnDisplayNames;
+	// One exported value per column. Rows are looked up by name, never by index: rows are inserted & reordered
+	TMap<FName, TArray<FString>> RowToValues;
+
+	static TSharedRef<const FPropertyHistoryDataTableRevision> FindOrDecode(const UDataTable& DataTable);
+	// Row structs are edited outside of any object: find the data table owning the row memory among the ones being edited
+	static UDataTable* FindEditedRow(const UScriptStruct& Struct, const void* RowData, FName& OutRowName);
+};
+
+// Changes of all the columns of a data table row
+class FPropertyHistoryDataTableRowChanges : public FPropertyHistoryChangeTable
+{
+public:
+	explicit FPropertyHistoryDataTableRowChanges(const FName RowName)
+		: RowName(RowName)
+	{
+	}
+
+	//~ Begin FPropertyHistoryChangeTable Interface
+	virtual FText GetTitle() const override;
+	//~ End FPropertyHistoryChangeTable Interface
+
+protected:
+	//~ Begin FPropertyHistoryChangeTable Interface
+	virtual bool ExtractValues(UObject& Object, TMap<FString, FValue>& OutValues) const override;
+	//~ End FPropertyHistoryChangeTable Interface
+
+private:
+	const FName RowName;
+};
+
+// Changes of one column across all the rows of a data table
+class FPropertyHistoryDataTableColumnChanges : public FPropertyHistoryChangeTable
+{
+public:
+	explicit FPropertyHistoryDataTableColumnChanges(const FName ColumnName)
+		: ColumnName(ColumnName)
+	{
+	}
+
+	//~ Begin FPropertyHistoryChangeTable Interface
+	virtual FText GetTitle() const override;
+	//~ End FPropertyHistoryChangeTable Interface
+
+protected:
+	//~ Begin FPropertyHistoryChangeTable Interface
+	virtual bool ExtractValues(UObject& Object, TMap<FString, FValue>& OutValues) const override;
+	//~ End FPropertyHistoryChangeTable Interface
+
+private:
+	const FName ColumnName;
+};
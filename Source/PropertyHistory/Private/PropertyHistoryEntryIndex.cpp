@@ -0,0 +1,290 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryEntryIndex.h"
+#include "PropertyHistoryHandler.h"
+#include "PropertyHistoryNumericColumns.h"
+#include "ISourceControlRevision.h"
+#include "Algo/BinarySearch.h"
+
+void FPropertyHistoryEntryIndex::Build(const TArray<TSharedPtr<FPropertyHistoryEntry>>& NewEntries)
+{
+	NumEntries = NewEntries.Num();
+	Dates.Reset(NumEntries);
+	Numbers.Reset(NumEntries);
+	StringValueToEntries.Reset();
+
+	TMap<FString, TArray<int32>> TokenToEntries;
+	TMap<FString, TArray<int32>> AuthorToEntries;
+
+	// Entries sharing a value share its strings
+	TMap<const FPropertyHistoryValue*, FString> ValueToString;
+
+	for (int32 Index = 0; Index < NewEntries.Num(); Index++)
+	{
+		const FPropertyHistoryEntry& Entry = *NewEntries[Index];
+		const ISourceControlRevision& Revision = *Entry.Revision;
+
+		{
+			TArray<FString> Tokens;
+			FString Token;
+			for (const TCHAR Char : Revision.GetDescription() + TEXT(" "))
+			{
+				if (FChar::IsAlnum(Char) ||
+					Char == TEXT('_'))
+				{
+					Token.AppendChar(FChar::ToLower(Char));
+					continue;
+				}
+
+				if (!Token.IsEmpty())
+				{
+					Tokens.AddUnique(MoveTemp(Token));
+					Token.Reset();
+				}
+			}
+
+			for (const FString& UniqueToken : Tokens)
+			{
+				TokenToEntries.FindOrAdd(UniqueToken).Add(Index);
+			}
+		}
+
+		AuthorToEntries.FindOrAdd(Revision.GetUserName().ToLower()).Add(Index);
+		Dates.Add({ Revision.GetDate(), Index });
+
+		const FPropertyHistoryValue* Value = Entry.Value.Get();
+
+		// Vectors & colors are not numbers here, only single channel values are
+		const bool bIsNumber =
+			Value &&
+			Value->NumericColumns &&
+			Value->NumericColumns->NumChannels() == 1;
+
+		Numbers.Add(bIsNumber ? Value->NumericColumns->GetColumn(0)[Value->NumericRow] : std::numeric_limits<double>::quiet_NaN());
+
+		if (!Value)
+		{
+			continue;
+		}
+
+		if (!ValueToString.Contains(Value))
+		{
+			// Objects are compared by name, eg value==T_Foo
+			ValueToString.Add(Value, Value->ExportText().ToLower());
+		}
+
+		StringValueToEntries.FindOrAdd(ValueToString[Value]).Add(Index);
+	}
+
+	DescriptionTokens = MakeSortedLists(MoveTemp(TokenToEntries));
+	Authors = MakeSortedLists(MoveTemp(AuthorToEntries));
+
+	Dates.Sort([](const TPair<FDateTime, int32>& A, const TPair<FDateTime, int32>& B)
+	{
+		return A.Key < B.Key;
+	});
+}
+
+TOptional<TBitArray<>> FPropertyHistoryEntryIndex::Filter(const FString& Query, FString& OutError) const
+{
+	TArray<FString> Terms;
+	{
+		TArray<FString> Words;
+		Query.ParseIntoArrayWS(Words);
+
+		// Allow spaces around value operators, eg value == T_Foo
+		for (const FString& Word : Words)
+		{
+			const bool bIsOperator = Word.Len() > 0 && FCString::Strchr(TEXT("<>=!"), Word[0]);
+			if (Terms.Num() > 0 &&
+				(bIsOperator || FCString::Strchr(TEXT("<>="), Terms.Last()[Terms.Last().Len() - 1])) &&
+				Terms.Last().StartsWith("value"))
+			{
+				Terms.Last() += Word;
+				continue;
+			}
+
+			Terms.Add(Word);
+		}
+	}
+
+	TBitArray<> Matches(true, NumEntries);
+	for (const FString& Term : Terms)
+	{
+		TBitArray<> TermMatches(false, NumEntries);
+		if (!FilterTerm(Term, TermMatches, OutError))
+		{
+			return {};
+		}
+
+		Matches.CombineWithBitwiseAND(TermMatches, EBitwiseOperatorFlags::MinSize);
+	}
+
+	return Matches;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FPropertyHistoryEntryIndex::AddPrefixMatches(const TArray<FPostingList>& Lists, const FString& Prefix, TBitArray<>& Matches)
+{
+	const FString LowerPrefix = Prefix.ToLower();
+
+	int32 Index = Algo::LowerBoundBy(Lists, LowerPrefix, [](const FPostingList& List) -> const FString&
+	{
+		return List.Key;
+	});
+
+	for (; Index < Lists.Num() && Lists[Index].Key.StartsWith(LowerPrefix, ESearchCase::CaseSensitive); Index++)
+	{
+		for (const int32 EntryIndex : Lists[Index].Entries)
+		{
+			Matches[EntryIndex] = true;
+		}
+	}
+}
+
+TArray<FPropertyHistoryEntryIndex::FPostingList> FPropertyHistoryEntryIndex::MakeSortedLists(TMap<FString, TArray<int32>>&& KeyToEntries)
+{
+	TArray<FPostingList> Lists;
+	Lists.Reserve(KeyToEntries.Num());
+
+	for (auto& It : KeyToEntries)
+	{
+		Lists.Add({ MoveTemp(It.Key), MoveTemp(It.Value) });
+	}
+
+	Lists.Sort([](const FPostingList& A, const FPostingList& B)
+	{
+		// Same ordering as the binary search
+		return A.Key < B.Key;
+	});
+
+	return Lists;
+}
+
+bool FPropertyHistoryEntryIndex::FilterTerm(const FString& Term, TBitArray<>& Matches, FString& OutError) const
+{
+	FString Key;
+	FString Operand;
+	if (Term.Split(":", &Key, &Operand))
+	{
+		Key.ToLowerInline();
+
+		if (Key == "author")
+		{
+			AddPrefixMatches(Authors, Operand, Matches);
+			return true;
+		}
+
+		if (Key == "after" ||
+			Key == "before")
+		{
+			FDateTime Date;
+			if (!FDateTime::ParseIso8601(*Operand, Date) &&
+				!FDateTime::Parse(Operand, Date))
+			{
+				OutError = "Invalid date: " + Operand;
+				return false;
+			}
+
+			const int32 Index = Algo::LowerBoundBy(Dates, Date, [](const TPair<FDateTime, int32>& Pair)
+			{
+				return Pair.Key;
+			});
+
+			const int32 Start = Key == "after" ? Index : 0;
+			const int32 End = Key == "after" ? Dates.Num() : Index;
+			for (int32 DateIndex = Start; DateIndex < End; DateIndex++)
+			{
+				Matches[Dates[DateIndex].Value] = true;
+			}
+			return true;
+		}
+	}
+
+	if (Term.StartsWith("value"))
+	{
+		const FString Condition = Term.RightChop(5);
+
+		for (const TCHAR* Operator : { TEXT(">="), TEXT("<="), TEXT("=="), TEXT("!="), TEXT(">"), TEXT("<"), TEXT("=") })
+		{
+			if (!Condition.StartsWith(Operator))
+			{
+				continue;
+			}
+
+			if (!FilterValue(Operator, Condition.RightChop(FCString::Strlen(Operator)), Matches))
+			{
+				OutError = "Invalid value condition: " + Term;
+				return false;
+			}
+			return true;
+		}
+	}
+
+	AddPrefixMatches(DescriptionTokens, Term, Matches);
+	return true;
+}
+
+bool FPropertyHistoryEntryIndex::FilterValue(const FString& Operator, const FString& Operand, TBitArray<>& Matches) const
+{
+	if (Operand.IsEmpty())
+	{
+		return false;
+	}
+
+	double Number = 0.;
+	const bool bIsNumber = LexTryParseString(Number, *Operand);
+
+	if (Operator == "==" ||
+		Operator == "=" ||
+		Operator == "!=")
+	{
+		if (bIsNumber)
+		{
+			FPropertyHistoryNumericColumns::Compare(Numbers, EPropertyHistoryComparison::Equal, Number, Matches);
+		}
+
+		if (const TArray<int32>* Entries = StringValueToEntries.Find(Operand.ToLower()))
+		{
+			for (const int32 EntryIndex : *Entries)
+			{
+				Matches[EntryIndex] = true;
+			}
+		}
+
+		if (Operator == "!=")
+		{
+			Matches.BitwiseNOT();
+		}
+		return true;
+	}
+
+	if (!bIsNumber)
+	{
+		return false;
+	}
+
+	EPropertyHistoryComparison Comparison = EPropertyHistoryComparison::LessEqual;
+	if (Operator == ">")
+	{
+		Comparison = EPropertyHistoryComparison::Greater;
+	}
+	else if (Operator == ">=")
+	{
+		Comparison = EPropertyHistoryComparison::GreaterEqual;
+	}
+	else if (Operator == "<")
+	{
+		Comparison = EPropertyHistoryComparison::Less;
+	}
+	else
+	{
+		ensure(Operator == "<=");
+	}
+
+	FPropertyHistoryNumericColumns::Compare(Numbers, Comparison, Number, Matches);
+	return true;
+}
@@ -0,0 +1,49 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FPropertyHistoryEntry;
+
+// Indexes the root entries of a history so that filters never scan them one by one
+// Queries are space separated terms, all of which must match:
+// - author:Name		authors starting with Name
+// - after:2024-01-01	before:2024-01-01
+// - value>100			value>=, value<, value<=, value==T_Foo, value!=T_Foo
+// - any other word		description words starting with it
+class FPropertyHistoryEntryIndex
+{
+public:
+	// Entries newest first
+	void Build(const TArray<TSharedPtr<FPropertyHistoryEntry>>& NewEntries);
+
+	// Unset if the query is invalid, otherwise one bit per entry
+	TOptional<TBitArray<>> Filter(const FString& Query, FString& OutError) const;
+
+private:
+	struct FPostingList
+	{
+		FString Key;
+		// Sorted entry indices
+		TArray<int32> Entries;
+	};
+
+	int32 NumEntries = 0;
+
+	// Sorted by key, so that prefixes are a single range
+	TArray<FPostingList> DescriptionTokens;
+	TArray<FPostingList> Authors;
+	// Sorted by date
+	TArray<TPair<FDateTime, int32>> Dates;
+
+	// One per entry, NaN if not a number. Filtered by a column kernel, see FPropertyHistoryNumericColumns
+	TArray<double> Numbers;
+	TMap<FString, TArray<int32>> StringValueToEntries;
+
+	static void AddPrefixMatches(const TArray<FPostingList>& Lists, const FString& Prefix, TBitArray<>& Matches);
+	static TArray<FPostingList> MakeSortedLists(TMap<FString, TArray<int32>>&& KeyToEntries);
+
+	bool FilterTerm(const FString& Term, TBitArray<>& Matches, FString& OutError) const;
+	bool FilterValue(const FString& Operator, const FString& Operand, TBitArray<>& Matches) const;
+};
@@ -0,0 +1,297 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryGitLfs.h"
+#include "ISourceControlModule.h"
+#include "ISourceControlProvider.h"
+#include "SourceControlHelpers.h"
+#include "PropertyHistoryRevisionData.h"
+
+static TAutoConsoleVariable<bool> CVarPropertyHistoryGitLfs(
+	TEXT("PropertyHistory.GitLfs"),
+	true,
+	TEXT("If true, revisions stored in Git LFS are read from the local LFS object store, and missing objects are fetched in batches"));
+
+namespace PropertyHistoryGitLfs
+{
+	// Pointer files are always smaller than this, see the spec
+	constexpr int64 MaxPointerSize = 1024;
+
+	// Unset until searched, empty if the project is not in a Git repository
+	TOptional<TPair<FString, FString>> RepositoryAndGitDirectory;
+
+	TPair<FString, FString> FindRepository(const FString& StartDirectory)
+	{
+		FString Directory = FPaths::ConvertRelativePathToFull(StartDirectory);
+		FPaths::NormalizeDirectoryName(Directory);
+
+		while (!Directory.IsEmpty())
+		{
+			const FString DotGit = Directory / ".git";
+			if (IFileManager::Get().DirectoryExists(*DotGit))
+			{
+				return { Directory, DotGit };
+			}
+
+			// Worktrees & submodules: .git is a file pointing to the git directory
+			FString GitFile;
+			if (FFileHelper::LoadFileToString(GitFile, *DotGit, FFileHelper::EHashOptions::None, FILEREAD_Silent) &&
+				GitFile.StartsWith("gitdir:"))
+			{
+				FString GitDirectory = GitFile.RightChop(7).TrimStartAndEnd();
+				if (FPaths::IsRelative(GitDirectory))
+				{
+					GitDirectory = FPaths::ConvertRelativePathToFull(Directory, GitDirectory);
+				}
+
+				// LFS objects are in the common directory of all the worktrees
+				FString CommonDirectory;
+				if (FFileHelper::LoadFileToString(CommonDirectory, *(GitDirectory / "commondir"), FFileHelper::EHashOptions::None, FILEREAD_Silent))
+				{
+					GitDirectory = FPaths::ConvertRelativePathToFull(GitDirectory, CommonDirectory.TrimStartAndEnd());
+				}
+
+				return { Directory, GitDirectory };
+			}
+
+			const FString Parent = FPaths::GetPath(Directory);
+			if (Parent == Directory)
+			{
+				break;
+			}
+			Directory = Parent;
+		}
+
+		return {};
+	}
+
+	// Same binary as the provider
+	FString FindGitBinary()
+	{
+		FString GitBinary;
+		if (!GConfig->GetString(TEXT("GitSourceControl.GitSourceControlSettings"), TEXT("BinaryPath"), GitBinary, SourceControlHelpers::GetSettingsIni()) ||
+			GitBinary.IsEmpty())
+		{
+			return "git";
+		}
+		return GitBinary;
+	}
+}
+
+FPropertyHistoryGitLfs FPropertyHistoryGitLfs::Get()
+{
+	using namespace PropertyHistoryGitLfs;
+	check(IsInGameThread());
+
+	FPropertyHistoryGitLfs GitLfs;
+
+	if (!CVarPropertyHistoryGitLfs.GetValueOnGameThread() ||
+		!ISourceControlModule::Get().IsEnabled() ||
+		!ISourceControlModule::Get().GetProvider().GetName().ToString().StartsWith("Git"))
+	{
+		return GitLfs;
+	}
+
+	if (!RepositoryAndGitDirectory.IsSet())
+	{
+		RepositoryAndGitDirectory = FindRepository(FPaths::ProjectDir());
+	}
+
+	GitLfs.RepositoryDirectory = RepositoryAndGitDirectory->Key;
+	GitLfs.GitDirectory = RepositoryAndGitDirectory->Value;
+	GitLfs.GitBinary = FindGitBinary();
+
+	return GitLfs;
+}
+
+FPropertyHistoryGitLfs FPropertyHistoryGitLfs::Find(const FString& Directory)
+{
+	using namespace PropertyHistoryGitLfs;
+	check(IsInGameThread());
+
+	const TPair<FString, FString> RepositoryAndGit = FindRepository(Directory);
+
+	FPropertyHistoryGitLfs GitLfs;
+	GitLfs.RepositoryDirectory = RepositoryAndGit.Key;
+	GitLfs.GitDirectory = RepositoryAndGit.Value;
+	GitLfs.GitBinary = FindGitBinary();
+	return GitLfs;
+}
+
+TArray<TArray<FString>> FPropertyHistoryGitLfs::MakePrefetchBatches(const TConstArrayView<FString> Revisions)
+{
+	TArray<TArray<FString>> Batches;
+	for (int32 Start = 0; Start < Revisions.Num(); Start += MaxRevisionsPerPrefetch)
+	{
+		Batches.Emplace(Revisions.Slice(Start, FMath::Min(MaxRevisionsPerPrefetch, Revisions.Num() - Start)));
+	}
+	return Batches;
+}
+
+TSharedPtr<FPropertyHistoryRevisionData> FPropertyHistoryGitLfs::Fetch(const FString& PackageFilename, const FString& Revision) const
+{
+	const FString ObjectPath = FindObjectPath(PackageFilename, Revision);
+	if (ObjectPath.IsEmpty())
+	{
+		return nullptr;
+	}
+
+	// Objects are never modified once in the store: map them in place
+	return FPropertyHistoryRevisionData::MapFile(ObjectPath);
+}
+
+FString FPropertyHistoryGitLfs::FindObjectPath(const FString& PackageFilename, const FString& Revision) const
+{
+	using namespace PropertyHistoryGitLfs;
+
+	if (!IsEnabled())
+	{
+		return {};
+	}
+
+	const FString RelativePath = GetRelativePath(PackageFilename);
+	if (RelativePath.IsEmpty())
+	{
+		return {};
+	}
+
+	const FString Object = "\"" + Revision + ":" + RelativePath + "\"";
+
+	// Check the size first: blobs that are not pointers can be huge, and are not text
+	FString SizeString;
+	int64 Size = 0;
+	if (!RunGit("cat-file -s " + Object, SizeString) ||
+		!LexTryParseString(Size, *SizeString.TrimStartAndEnd()) ||
+		Size >= MaxPointerSize)
+	{
+		return {};
+	}
+
+	FString PointerString;
+	if (!RunGit("cat-file blob " + Object, PointerString))
+	{
+		return {};
+	}
+
+	const TOptional<FPointer> Pointer = ParsePointer(PointerString);
+	if (!Pointer)
+	{
+		return {};
+	}
+
+	const FString ObjectPath = GetObjectPath(Pointer->Oid);
+	if (IFileManager::Get().FileSize(*ObjectPath) != Pointer->Size)
+	{
+		// Not fetched yet, or being written by git lfs
+		return {};
+	}
+
+	return ObjectPath;
+}
+
+void FPropertyHistoryGitLfs::Prefetch(const FString& PackageFilename, const TArray<FString>& Revisions) const
+{
+	using namespace PropertyHistoryGitLfs;
+
+	if (!IsEnabled() ||
+		Revisions.Num() == 0 ||
+		!ensure(Revisions.Num() <= MaxRevisionsPerPrefetch))
+	{
+		return;
+	}
+
+	const FString RelativePath = GetRelativePath(PackageFilename);
+	if (RelativePath.IsEmpty())
+	{
+		return;
+	}
+
+	FString Remote;
+	if (!RunGit("config --get lfs.remote", Remote) ||
+		Remote.TrimStartAndEnd().IsEmpty())
+	{
+		Remote = "origin";
+	}
+	Remote.TrimStartAndEndInline();
+
+	FString Params = "lfs fetch " + Remote;
+	for (const FString& Revision : Revisions)
+	{
+		Params += " " + Revision;
+	}
+	Params += " --include=\"" + RelativePath + "\"";
+
+	// Failures are fine: revisions whose object is missing go through the provider
+	FString StdOut;
+	RunGit(Params, StdOut);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+TOptional<FPropertyHistoryGitLfs::FPointer> FPropertyHistoryGitLfs::ParsePointer(const FString& Text)
+{
+	TArray<FString> Lines;
+	Text.ParseIntoArrayLines(Lines);
+
+	if (Lines.Num() == 0 ||
+		!Lines[0].StartsWith("version https://git-lfs.github.com/spec/"))
+	{
+		return {};
+	}
+
+	FPointer Pointer;
+	bool bHasSize = false;
+	for (const FString& Line : Lines)
+	{
+		if (Line.StartsWith("oid sha256:"))
+		{
+			Pointer.Oid = Line.RightChop(11).TrimEnd();
+		}
+		else if (Line.StartsWith("size "))
+		{
+			bHasSize = LexTryParseString(Pointer.Size, *Line.RightChop(5).TrimEnd());
+		}
+	}
+
+	if (Pointer.Oid.Len() != 64 ||
+		!bHasSize)
+	{
+		return {};
+	}
+
+	for (const TCHAR Char : Pointer.Oid)
+	{
+		if (!FChar::IsHexDigit(Char))
+		{
+			return {};
+		}
+	}
+
+	return Pointer;
+}
+
+FString FPropertyHistoryGitLfs::GetObjectPath(const FString& Oid) const
+{
+	return GitDirectory / "lfs" / "objects" / Oid.Left(2) / Oid.Mid(2, 2) / Oid;
+}
+
+FString FPropertyHistoryGitLfs::GetRelativePath(const FString& PackageFilename) const
+{
+	FString RelativePath = FPaths::ConvertRelativePathToFull(PackageFilename);
+	if (!FPaths::MakePathRelativeTo(RelativePath, *(RepositoryDirectory + "/")) ||
+		RelativePath.StartsWith(".."))
+	{
+		return {};
+	}
+	return RelativePath;
+}
+
+bool FPropertyHistoryGitLfs::RunGit(const FString& Params, FString& OutStdOut) const
+{
+	int32 ReturnCode = 0;
+	FString StdErr;
+	return
+		FPlatformProcess::ExecProcess(*GitBinary, *Params, &ReturnCode, &OutStdOut, &StdErr, *RepositoryDirectory) &&
+		ReturnCode == 0;
+}
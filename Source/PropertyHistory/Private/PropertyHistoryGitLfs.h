@@ -0,0 +1,64 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FPropertyHistoryRevisionData;
+
+// Reads revisions stored in Git LFS straight from the local LFS object store,
+// instead of going through the provider, the smudge filter and a temp file
+// Blobs of LFS files are small pointers giving the oid & size of the object, found in .git/lfs/objects once fetched
+// Read on the game thread, then passed to the workers
+struct FPropertyHistoryGitLfs
+{
+	FString GitBinary;
+	// Root of the working tree
+	FString RepositoryDirectory;
+	// Common git directory, shared by all the worktrees
+	FString GitDirectory;
+
+	// Disabled unless the provider is Git and the project is in a Git repository
+	// Must be called on the game thread
+	static FPropertyHistoryGitLfs Get();
+	// Repository containing Directory no matter the provider, eg to check a test repository
+	// Disabled if Directory is not in a Git repository
+	static FPropertyHistoryGitLfs Find(const FString& Directory);
+
+	bool IsEnabled() const
+	{
+		return !GitDirectory.IsEmpty();
+	}
+
+	// Keeps command lines short enough for every platform
+	static constexpr int32 MaxRevisionsPerPrefetch = 32;
+	// Splits revisions into the batches passed to Prefetch, keeping their order
+	static TArray<TArray<FString>> MakePrefetchBatches(TConstArrayView<FString> Revisions);
+
+	// Can be called from any thread
+	// Null if the revision is not in LFS or its object is not in the local store: it should then be fetched through the provider
+	TSharedPtr<FPropertyHistoryRevisionData> Fetch(const FString& PackageFilename, const FString& Revision) const;
+	// Empty if the revision is not in LFS or its object is not in the local store
+	FString FindObjectPath(const FString& PackageFilename, const FString& Revision) const;
+	// Downloads the LFS objects of a batch of revisions in a single git lfs fetch, objects already in the local store are skipped
+	// At most MaxRevisionsPerPrefetch revisions, see MakePrefetchBatches
+	void Prefetch(const FString& PackageFilename, const TArray<FString>& Revisions) const;
+
+public:
+	struct FPointer
+	{
+		// SHA256 of the object
+		FString Oid;
+		int64 Size = 0;
+	};
+	// See https://github.com/git-lfs/git-lfs/blob/main/docs/spec.md
+	static TOptional<FPointer> ParsePointer(const FString& Text);
+
+	FString GetObjectPath(const FString& Oid) const;
+	// Runs in the repository directory, false if git failed
+	bool RunGit(const FString& Params, FString& OutStdOut) const;
+
+private:
+	// Empty if the file is not in the repository
+	FString GetRelativePath(const FString& PackageFilename) const;
+};
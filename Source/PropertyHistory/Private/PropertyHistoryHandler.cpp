@@ -1,76 +1,99 @@
 ﻿// Copyright Voxel Plugin SAS. All Rights Reserved.
 
 #include "PropertyHistoryHandler.h"
-#include "DiffUtils.h"
-#include "Async/Async.h"
 #include "SPropertyHistory.h"
-#include "ISourceControlModule.h"
+#include "PropertyHistoryReplay.h"
 #include "SourceControlHelpers.h"
 #include "SourceControlWindows.h"
-#include "SourceControlOperations.h"
 #include "PropertyHistoryUtilities.h"
 #include "PropertyHistoryProcessor.h"
 
-FPropertyHistoryHandler::FPropertyHistoryHandler(const FPropertyHistoryProcessor& Processor)
-	: PropertyChain(Processor.Properties)
-	, PropertyGuid(Processor.Guid)
-{
-}
+static TAutoConsoleVariable<bool> CVarPropertyHistoryCheckFingerprintCollisions(
+	TEXT("PropertyHistory.CheckFingerprintCollisions"),
+	false,
+	TEXT("If true, values with the same fingerprint are also compared property by property before being interned"));
 
-bool FPropertyHistoryHandler::Initialize(const UObject& Object)
+FString FPropertyHistoryValue::ExportText(FString* OutToolTip) const
 {
-	const ISourceControlProvider& SourceControlProvider = ISourceControlModule::Get().GetProvider();
-	if (!SourceControlProvider.IsEnabled())
+	const FPropertyBagPropertyDesc* PropertyDesc = Bag.FindPropertyDescByName("Value");
+	if (!ensure(PropertyDesc))
 	{
-		return false;
+		return "<Error>";
 	}
 
+	if (PropertyDesc->IsObjectType())
 	{
-		const UObject* CurrentObject = &Object;
-		OuterChain.Add(CurrentObject);
-
-		while (
-			!CurrentObject->IsA<UPackage>() &&
-			!CurrentObject->IsPackageExternal())
+		const TValueOrError<UObject*, EPropertyBagResult> WrappedObject = Bag.GetValueObject("Value");
+		if (!WrappedObject.IsValid())
 		{
-			CurrentObject = CurrentObject->GetOuter();
+			return "<Error>";
+		}
 
-			if (!CurrentObject)
-			{
-				return false;
-			}
+		const UObject* Object = WrappedObject.GetValue();
+		if (!Object)
+		{
+			return "null";
+		}
 
-			OuterChain.Add(CurrentObject);
+		if (OutToolTip)
+		{
+			*OutToolTip = Object->GetPathName();
 		}
+
+		return Object->GetName();
 	}
 
-	// Also handles UPackage
-	const UPackage* Package = OuterChain.Last()->GetExternalPackage();
-	if (!ensure(Package))
+	const TValueOrError<FString, EPropertyBagResult> Value = Bag.GetValueSerializedString("Value");
+	if (!Value.IsValid())
 	{
-		return false;
+		return "<Error>";
 	}
 
-	const FString PackageName = Package->GetName();
-	const TArray<FString> PackageFilenames = SourceControlHelpers::PackageFilenames({ PackageName });
+	return Value.GetValue();
+}
 
-	if (!ensure(PackageFilenames.Num() == 1))
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FPropertyHistoryHandler::FPropertyHistoryHandler(const FPropertyHistoryProcessor& Processor)
+	: PropertyChain(Processor.Properties)
+	, PropertyGuid(Processor.Guid)
+{
+}
+
+bool FPropertyHistoryHandler::Initialize(const UObject& Object)
+{
+	if (!FPropertyHistoryReplay::IsSourceControlEnabled())
 	{
 		return false;
 	}
 
-	PackageFilename = PackageFilenames[0];
+	if (!ObjectPath.Initialize(Object))
+	{
+		return false;
+	}
+
+	PackageFilename = ObjectPath.GetPackageFilename();
+
+	NumericColumns = MakeShared<FPropertyHistoryNumericColumns>();
+	if (!NumericColumns->Initialize(*PropertyChain[0].Property))
+	{
+		NumericColumns.Reset();
+	}
+
+	Streams = MakeShared<FPropertyHistoryObjectStreams>(ObjectPath);
+	Streams->OnUpdated.AddSP(this, &FPropertyHistoryHandler::ProcessStreams);
+	Streams->OnStateChanged.AddSPLambda(this, [this]
+	{
+		OnStateChanged.Broadcast();
+	});
 
 	return true;
 }
 
 void FPropertyHistoryHandler::ShowHistory()
 {
-	ISourceControlProvider& SourceControlProvider = ISourceControlModule::Get().GetProvider();
-
-	const TSharedRef<FUpdateStatus> UpdateStatusOperation = ISourceControlOperation::Create<FUpdateStatus>();
-	UpdateStatusOperation->SetUpdateHistory(true);
-
 	ON_SCOPE_EXIT
 	{
 		const TSharedPtr<SDockTab> NewTab = FGlobalTabmanager::Get()->TryInvokeTab(FName("PropertyHistoryTab"));
@@ -85,6 +108,11 @@ void FPropertyHistoryHandler::ShowHistory()
 		FSlateApplication::Get().SetKeyboardFocus(PropertyHistoryWidget, EFocusCause::SetDirectly);
 	};
 
+	Subscribe();
+}
+
+void FPropertyHistoryHandler::Subscribe()
+{
 	if (PropertyChain[0].Property->IsA<FSetProperty>())
 	{
 		AddError("Set container type variables cannot be previewed. Preview inner items.");
@@ -97,27 +125,14 @@ void FPropertyHistoryHandler::ShowHistory()
 		return;
 	}
 
-	if (!SourceControlProvider.Execute(
-		UpdateStatusOperation,
-		{ PackageFilename },
-		EConcurrency::Asynchronous,
-		MakeLambdaDelegate(MakeWeakPtrLambda(this, [this](const FSourceControlOperationRef&, const ECommandResult::Type Result)
-		{
-			check(IsInGameThread());
-
-			if (Result != ECommandResult::Succeeded)
-			{
-				AddError("Failed to update status for " + PackageFilename);
-				return;
-			}
-
-			ensure(bWaitingForUpdateStatus);
-			ensure(!bUpdateStatusReady);
-			bUpdateStatusReady = true;
-		}))))
+	if (Streams->IsSubscribed())
 	{
-		AddError("Failed to update status for " + PackageFilename);
+		return;
 	}
+	Streams->Subscribe();
+
+	// Catch up with what the streams already loaded for other handlers
+	ProcessStreams();
 }
 
 void FPropertyHistoryHandler::ShowFullHistory()
@@ -125,6 +140,16 @@ void FPropertyHistoryHandler::ShowFullHistory()
 	FSourceControlWindows::DisplayRevisionHistory({ PackageFilename });
 }
 
+void FPropertyHistoryHandler::Cancel()
+{
+	Streams->Unsubscribe();
+}
+
+void FPropertyHistoryHandler::MakePriority() const
+{
+	Streams->MakePriority();
+}
+
 bool FPropertyHistoryHandler::IsLoading() const
 {
 	if (Error.IsSet())
@@ -132,216 +157,226 @@ bool FPropertyHistoryHandler::IsLoading() const
 		return false;
 	}
 
-	if (!SourceControlState)
-	{
-		return true;
-	}
-
-	return HistoryIndex < SourceControlState->GetHistorySize();
+	return Streams->IsLoading();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
-bool FPropertyHistoryHandler::Tick(float DeltaTime)
-{
-	Tick();
-	return true;
-}
-
-void FPropertyHistoryHandler::Tick()
+void FPropertyHistoryHandler::ProcessStreams()
 {
-	if (bWaitingForUpdateStatus)
+	for (const FString& StreamError : Streams->ConsumeErrors())
 	{
-		if (!bUpdateStatusReady)
-		{
-			return;
-		}
-
-		ISourceControlProvider& SourceControlProvider = ISourceControlModule::Get().GetProvider();
+		AddError(StreamError);
+	}
 
-		TArray<FSourceControlStateRef> SourceControlStates;
-		if (SourceControlProvider.GetState(
-			{ PackageFilename },
-			SourceControlStates,
-			EStateCacheUsage::Use) != ECommandResult::Succeeded)
+	const TArray<TSharedRef<FPropertyHistoryRevision>> Revisions = Streams->GetRevisions();
+	for (const TSharedRef<FPropertyHistoryRevision>& Revision : Revisions)
+	{
+		if (!Revision->bLoaded ||
+			RevisionIdToEntry.Contains(Revision->Id))
 		{
-			SourceControlStates.Empty();
+			continue;
 		}
 
-		if (SourceControlStates.Num() != 1)
+		if (!Revision->Package &&
+			!Revision->bLoadFailed)
 		{
-			AddError("Failed to get source control state for " + PackageFilename);
-			return;
+			// Unloaded before we were opened
+			Streams->RequestReload(Revision);
+			continue;
 		}
 
-		SourceControlState = SourceControlStates[0];
+		RevisionIdToEntry.Add(Revision->Id, ProcessRevision(*Revision));
 	}
 
-	if (!SourceControlState)
+	RebuildEntries(Revisions);
+}
+
+TSharedPtr<FPropertyHistoryEntry> FPropertyHistoryHandler::ProcessRevision(const FPropertyHistoryRevision& Revision)
+{
+	if (Revision.bLoadFailed)
 	{
-		return;
+		// Error is reported by the stream
+		return nullptr;
 	}
 
-	if (Future.IsSet() &&
-		!Future->IsReady())
+	UObject* NewObject = ObjectPath.Resolve(Revision);
+	if (!NewObject)
 	{
-		return;
+		return nullptr;
 	}
 
-	if (HistoryIndex == SourceControlState->GetHistorySize())
+	FPropertyHistoryProcessor Processor(NewObject, PropertyChain, PropertyGuid);
+	void* Container = nullptr;
+	if (!Processor.Process(Container))
 	{
-		return;
+		return nullptr;
 	}
 
-	const TSharedPtr<ISourceControlRevision> Revision = SourceControlState->GetHistoryItem(HistoryIndex);
-	if (!Revision)
+	if (Container == nullptr)
 	{
-		AddError("Failed to get source control state for " + PackageFilename);
-		HistoryIndex++;
-		return;
+		return nullptr;
 	}
 
-	if (!Future.IsSet())
+	const FProperty& Property = *PropertyChain[0].Property;
+
+	// Hash the revision directly: values are only copied to a bag the first time they are seen
+	const TSharedRef<FPropertyHistoryHashNode> HashTree = MakeSharedCopy(FPropertyHistoryHashNode::Build(
+		Property,
+		Property.ContainerPtrToValuePtr<void>(Container)));
+
+	const TSharedPtr<FPropertyHistoryValue> PooledValue = FingerprintToValue.FindRef(HashTree->Hash);
+	if (PooledValue &&
+		!CVarPropertyHistoryCheckFingerprintCollisions.GetValueOnGameThread())
 	{
-		Future = Async(EAsyncExecution::LargeThreadPool, [Revision]
+		return EntryArena.Add(FPropertyHistoryEntry
 		{
-			FString TempFileName;
-			if (!Revision->Get(TempFileName, EConcurrency::Asynchronous))
-			{
-				TempFileName.Empty();
-			}
-			return TempFileName;
+			PooledValue,
+			Revision.Revision
 		});
-
-		return;
 	}
-	check(Future->IsReady());
-
-	HistoryIndex++;
-
-	const FString TempFileName = Future->Get();
-	Future.Reset();
 
-	const FPackagePath TempPackagePath = FPackagePath::FromLocalPath(TempFileName);
-	const FPackagePath OriginalPackagePath = FPackagePath::FromLocalPath(Revision->GetFilename());
-
-	UPackage* Package = DiffUtils::LoadPackageForDiff(TempPackagePath, OriginalPackagePath);
-	if (!Package)
+	FInstancedPropertyBag Bag;
+	if (!CopyToBag(Container, Bag))
 	{
-		AddError("Failed to load package for " + PackageFilename);
-		return;
+		return nullptr;
 	}
 
-	UObject* NewObject = Package;
-	for (const TWeakObjectPtr<const UObject>& WeakOuter : ReverseIterate(OuterChain))
+	if (PooledValue &&
+		PooledValue->Bag.Identical(&Bag, PPF_None))
 	{
-		const UObject* Outer = WeakOuter.Get();
-		if (!ensure(Outer))
+		return EntryArena.Add(FPropertyHistoryEntry
 		{
-			return;
-		}
-
-		if (Outer->IsA<UPackage>())
-		{
-			// Root package
-			ensure(NewObject == Package);
-			continue;
-		}
+			PooledValue,
+			Revision.Revision
+		});
+	}
 
-		NewObject = StaticFindObject(nullptr, NewObject, *Outer->GetName());
+	const TSharedRef<FPropertyHistoryValue> NewValue = ValueArena.Add(FPropertyHistoryValue
+	{
+		MoveTemp(Bag),
+		HashTree,
+		HashTree->Hash
+	});
 
-		if (!NewObject)
-		{
-			// Object did not exist yet
-			return;
-		}
+	if (NumericColumns)
+	{
+		// Read from the revision, same as the hash tree
+		NewValue->NumericColumns = NumericColumns;
+		NewValue->NumericRow = NumericColumns->AddRow(Property.ContainerPtrToValuePtr<void>(Container));
 	}
 
-	FPropertyHistoryProcessor Processor(NewObject, PropertyChain, PropertyGuid);
-	void* Container = nullptr;
-	if (!Processor.Process(Container))
+	// On collision the first value stays interned
+	if (!PooledValue)
 	{
-		return;
+		FingerprintToValue.Add(HashTree->Hash, NewValue);
 	}
 
-	if (Container == nullptr)
+	return EntryArena.Add(FPropertyHistoryEntry
 	{
-		return;
-	}
+		NewValue,
+		Revision.Revision
+	});
+}
 
-	FInstancedPropertyBag Value;
+bool FPropertyHistoryHandler::CopyToBag(const void* Container, FInstancedPropertyBag& OutBag)
+{
+	const FProperty& Property = *PropertyChain[0].Property;
 
-	const bool bValueSet = INLINE_LAMBDA
+	if (const FStructProperty* StructProperty = CastField<FStructProperty>(&Property))
 	{
-		if (const FStructProperty* StructProperty = CastField<FStructProperty>(PropertyChain[0].Property))
+		if (StructProperty->Struct == FInstancedStruct::StaticStruct())
 		{
-			if (StructProperty->Struct == FInstancedStruct::StaticStruct())
+			const FInstancedStruct& InstancedStruct = *StructProperty->ContainerPtrToValuePtr<FInstancedStruct>(Container);
+			if (!InstancedStruct.IsValid() ||
+				!InstancedStruct.GetMemory())
 			{
-				FInstancedStruct* InstancedStruct = StructProperty->ContainerPtrToValuePtr<FInstancedStruct>(Container);
-				if (!InstancedStruct->IsValid())
-				{
-					return false;
-				}
-
-				Container = InstancedStruct->GetMutableMemory();
-				if (!Container)
-				{
-					return false;
-				}
-
-				Value.AddProperty("Value", EPropertyBagPropertyType::Struct, InstancedStruct->GetScriptStruct());
-				const FConstStructView View(InstancedStruct->GetScriptStruct(), InstancedStruct->GetMutableMemory());
-				Value.SetValueStruct("Value", View);
-				return true;
+				return false;
 			}
-		}
 
-		Value.AddProperty("Value", PropertyChain[0].Property);
-		if (const FByteProperty* ByteProperty = CastField<FByteProperty>(PropertyChain[0].Property))
-		{
-			if (ByteProperty->Enum)
+			const UPropertyBag* Layout = FindOrAddLayout(InstancedStruct.GetScriptStruct());
+			if (!ensure(Layout))
 			{
-				if (!ensure(Value.SetValueEnum("Value", *PropertyChain[0].Property->ContainerPtrToValuePtr<uint8>(Container), ByteProperty->Enum) == EPropertyBagResult::Success))
-				{
-					return false;
-				}
-
-				return true;
+				return false;
 			}
+
+			OutBag.InitializeFromBagStruct(Layout);
+			return ensure(OutBag.SetValueStruct("Value", FConstStructView(InstancedStruct.GetScriptStruct(), InstancedStruct.GetMemory())) == EPropertyBagResult::Success);
 		}
+	}
+
+	const UPropertyBag* Layout = FindOrAddLayout(nullptr);
+	if (!ensure(Layout))
+	{
+		return false;
+	}
 
-		if (!ensure(Value.SetValue("Value", PropertyChain[0].Property, Container) == EPropertyBagResult::Success))
+	OutBag.InitializeFromBagStruct(Layout);
+
+	if (const FByteProperty* ByteProperty = CastField<FByteProperty>(&Property))
+	{
+		if (ByteProperty->Enum)
 		{
-			return false;
+			return ensure(OutBag.SetValueEnum("Value", *Property.ContainerPtrToValuePtr<uint8>(Container), ByteProperty->Enum) == EPropertyBagResult::Success);
 		}
+	}
 
-		return true;
-	};
+	return ensure(OutBag.SetValue("Value", &Property, Container) == EPropertyBagResult::Success);
+}
 
-	if (!bValueSet)
+const UPropertyBag* FPropertyHistoryHandler::FindOrAddLayout(const UScriptStruct* InstancedStruct)
+{
+	TWeakObjectPtr<const UPropertyBag>& Layout = StructToLayout.FindOrAdd(InstancedStruct);
+	if (Layout.IsValid())
 	{
-		return;
+		return Layout.Get();
 	}
 
-	const TSharedRef<FPropertyHistoryEntry> NewEntry = MakeSharedCopy(FPropertyHistoryEntry
-	{
-		MoveTemp(Value),
-		Revision
-	});
+	FPropertyBagPropertyDesc Desc = InstancedStruct
+		? FPropertyBagPropertyDesc("Value", EPropertyBagPropertyType::Struct, InstancedStruct)
+		: FPropertyBagPropertyDesc("Value", PropertyChain[0].Property);
+
+	// Bags get a new id per property added, which would make a new bag struct per value
+	// A deterministic id also lets every history of the same property share its layout
+	Desc.ID = FGuid::NewDeterministicGuid(InstancedStruct ? InstancedStruct->GetPathName() : PropertyChain[0].Property->GetPathName());
+
+	Layout = UPropertyBag::GetOrCreateFromDescs({ Desc });
+	return Layout.Get();
+}
 
-	if (Entries.Num() > 0 &&
-		Entries.Last()->Value.Identical(&NewEntry->Value, PPF_None))
+void FPropertyHistoryHandler::RebuildEntries(const TArray<TSharedRef<FPropertyHistoryRevision>>& Revisions)
+{
+	// Revisions are not necessarily processed in order, eg stored revisions are processed before newer ones are known
+	TArray<TSharedPtr<FPropertyHistoryEntry>> NewEntries;
+
+	for (const TSharedRef<FPropertyHistoryRevision>& Revision : Revisions)
 	{
-		// Replace the entry, the current one we have didn't change this property
-		Entries.Last() = NewEntry;
+		const TSharedPtr<FPropertyHistoryEntry> Entry = RevisionIdToEntry.FindRef(Revision->Id);
+		if (!Entry)
+		{
+			continue;
+		}
+
+		// Values are interned: same value means same pointer
+		if (NewEntries.Num() > 0 &&
+			NewEntries.Last()->Value == Entry->Value)
+		{
+			// Replace the entry, the current one we have didn't change this property
+			NewEntries.Last() = Entry;
+			continue;
+		}
+
+		NewEntries.Add(Entry);
 	}
-	else
+
+	if (NewEntries == Entries)
 	{
-		Entries.Add(NewEntry);
+		return;
 	}
 
+	Entries = MoveTemp(NewEntries);
 	OnNewEntry.Broadcast();
 }
 
@@ -355,4 +390,6 @@ void FPropertyHistoryHandler::AddError(const FString& NewError)
 	{
 		Error = NewError;
 	}
+
+	OnStateChanged.Broadcast();
 }
\ No newline at end of file
@@ -5,29 +5,75 @@
 #include "CoreMinimal.h"
 #include "StructUtils/PropertyBag.h"
 #include "PropertyHistoryProcessor.h"
+#include "PropertyHistoryHashTree.h"
+#include "PropertyHistoryArena.h"
+#include "PropertyHistoryNumericColumns.h"
+#include "PropertyHistoryObjectPath.h"
+#include "PropertyHistoryObjectStreams.h"
 
 class ISourceControlState;
 class FDetailColumnSizeData;
+class SWidget;
+
+// Extracted value, interned per history: revisions with the same value share it
+struct FPropertyHistoryValue
+{
+	FInstancedPropertyBag Bag;
+	TSharedPtr<const FPropertyHistoryHashNode> HashTree;
+	// Root hash of HashTree, equal fingerprints mean equal values
+	uint64 Fingerprint = 0;
+
+	// Set if the value is numeric: row of this value in the columns of its history
+	TSharedPtr<const FPropertyHistoryNumericColumns> NumericColumns;
+	int32 NumericRow = -1;
+
+	// Created by the UI the first time an entry with this value is shown
+	TSharedPtr<IPropertyRowGenerator> PropertyRowGenerator;
+	TSharedPtr<IDetailTreeNode> Node;
+
+	// Decided the first time the value is shown: values whose widget has no width are shown as text
+	enum class EDisplayMode : uint8
+	{
+		Unknown,
+		Widget,
+		Text
+	};
+	EDisplayMode DisplayMode = EDisplayMode::Unknown;
+	FString DisplayText;
+	FString DisplayToolTip;
+
+	// Name of the object for object values, serialized value otherwise
+	FString ExportText(FString* OutToolTip = nullptr) const;
+};
 
 struct FPropertyHistoryEntry
 {
-	FInstancedPropertyBag Value;
+	// Only set on root entries
+	TSharedPtr<FPropertyHistoryValue> Value;
 	TSharedPtr<ISourceControlRevision> Revision;
 
-	TSharedPtr<IPropertyRowGenerator> PropertyRowGenerator;
+	// Set on child entries whose value differs from the previous entry
+	bool bChanged = false;
+	// Root entries only: entry the children were last diffed against, and the children that were marked changed
+	TWeakPtr<FPropertyHistoryEntry> DiffedAgainst;
+	TArray<TWeakPtr<FPropertyHistoryEntry>> ChangedChildren;
+
+	// Tree items must be unique: entries sharing a value still have their own children, pointing to the same nodes
 	TSharedPtr<IDetailTreeNode> Node;
 	TSharedPtr<IPropertyHandle> Handle;
 
 	TSharedPtr<FDetailColumnSizeData> ColumnSizeData;
 	TArray<TSharedPtr<FPropertyHistoryEntry>> Children;
+
+	// Root entries only, cached by the UI: reused when the row is generated again after being scrolled out of view
+	TSharedPtr<SWidget> ValueWidget;
 };
 
-class FPropertyHistoryHandler
-	: public TSharedFromThis<FPropertyHistoryHandler>
-	, public FTSTickerObjectBase
+class FPropertyHistoryHandler : public TSharedFromThis<FPropertyHistoryHandler>
 {
 public:
 	FSimpleMulticastDelegate OnNewEntry;
+	FSimpleMulticastDelegate OnStateChanged;
 	TArray<TSharedPtr<FPropertyHistoryEntry>> Entries;
 
 public:
@@ -36,6 +82,14 @@ public:
 	bool Initialize(const UObject& Object);
 	void ShowHistory();
 	void ShowFullHistory();
+	// Starts building the entries without showing them, eg when the history of several objects is shown at once
+	void Subscribe();
+
+	// Stops listening to the package streams. Streams themselves stop once no handler is listening to them anymore
+	// Calling ShowHistory again resumes where it left off
+	void Cancel();
+	// Makes this handler package load before all the others
+	void MakePriority() const;
 
 	bool IsLoading() const;
 
@@ -44,26 +98,34 @@ public:
 		return Error;
 	}
 
-protected:
-	//~ Begin FTSTickerObjectBase Interface
-	virtual bool Tick(float DeltaTime) override;
-	//~ End FTSTickerObjectBase Interface
-
 private:
 	TArray<FPropertyData> PropertyChain;
 	FString PackageFilename;
-	TArray<TWeakObjectPtr<const UObject>> OuterChain;
+	FPropertyHistoryObjectPath ObjectPath;
+	TSharedPtr<FPropertyHistoryObjectStreams> Streams;
+
+	// Revision id to its entry, null if the property could not be found in that revision
+	TMap<int32, TSharedPtr<FPropertyHistoryEntry>> RevisionIdToEntry;
+	// Interned values, properties often flip back and forth between the same values
+	TMap<uint64, TSharedPtr<FPropertyHistoryValue>> FingerprintToValue;
+
+	// Every value of a history has the same bag layout: the property itself under null, or one per instanced struct type
+	TMap<const UScriptStruct*, TWeakObjectPtr<const UPropertyBag>> StructToLayout;
+
+	// Null if the property is not numeric. One row per value, graphs & filters read these instead of the bags
+	TSharedPtr<FPropertyHistoryNumericColumns> NumericColumns;
 
-	bool bWaitingForUpdateStatus = true;
-	bool bUpdateStatusReady = false;
+	TPropertyHistoryArena<FPropertyHistoryEntry> EntryArena;
+	TPropertyHistoryArena<FPropertyHistoryValue> ValueArena;
 
 	TOptional<FString> Error;
-	int32 HistoryIndex = 0;
-	TOptional<TFuture<FString>> Future;
-	TSharedPtr<ISourceControlState> SourceControlState;
 
 	const FGuid PropertyGuid;
 
-	void Tick();
+	void ProcessStreams();
+	TSharedPtr<FPropertyHistoryEntry> ProcessRevision(const FPropertyHistoryRevision& Revision);
+	bool CopyToBag(const void* Container, FInstancedPropertyBag& OutBag);
+	const UPropertyBag* FindOrAddLayout(const UScriptStruct* InstancedStruct);
+	void RebuildEntries(const TArray<TSharedRef<FPropertyHistoryRevision>>& Revisions);
 	void AddError(const FString& NewError);
 };
\ No newline at end of file
@@ -0,0 +1,195 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryHashTree.h"
+#include "PropertyHistoryRevisionData.h"
+#include "Hash/CityHash.h"
+#include "StructUtils/InstancedStruct.h"
+
+FPropertyHistoryHashNode FPropertyHistoryHashNode::Build(const FProperty& Property, const void* Data)
+{
+	if (Property.ArrayDim == 1)
+	{
+		return BuildValue(Property, Data);
+	}
+
+	// Static array
+	FPropertyHistoryHashNode Node;
+	Node.bIsContainer = true;
+	for (int32 Index = 0; Index < Property.ArrayDim; Index++)
+	{
+		FPropertyHistoryHashNode& Child = Node.Children.Add_GetRef(BuildValue(Property, static_cast<const uint8*>(Data) + Index * Property.ElementSize));
+		Node.Hash = Combine(Node.Hash, Child.Hash);
+	}
+	return Node;
+}
+
+const FPropertyHistoryHashNode* FPropertyHistoryHashNode::FindChild(const int32 Index) const
+{
+	if (!bIsContainer ||
+		!Children.IsValidIndex(Index))
+	{
+		return nullptr;
+	}
+
+	return &Children[Index];
+}
+
+const FPropertyHistoryHashNode* FPropertyHistoryHashNode::FindChild(const FName ChildName) const
+{
+	if (bIsContainer)
+	{
+		return nullptr;
+	}
+
+	// Structs have few fields, no need for a map
+	return Children.FindByPredicate([&](const FPropertyHistoryHashNode& Child)
+	{
+		return Child.Name == ChildName;
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FPropertyHistoryHashNode FPropertyHistoryHashNode::BuildValue(const FProperty& Property, const void* Data)
+{
+	if (const FStructProperty* StructProperty = CastField<FStructProperty>(&Property))
+	{
+		if (StructProperty->Struct == FInstancedStruct::StaticStruct())
+		{
+			// Instanced structs are shown as their inner struct
+			const FInstancedStruct& InstancedStruct = *static_cast<const FInstancedStruct*>(Data);
+			if (!InstancedStruct.IsValid())
+			{
+				return {};
+			}
+
+			return BuildStruct(*InstancedStruct.GetScriptStruct(), InstancedStruct.GetMemory());
+		}
+
+		return BuildStruct(*StructProperty->Struct, Data);
+	}
+
+	FPropertyHistoryHashNode Node;
+
+	if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(&Property))
+	{
+		FScriptArrayHelper ArrayHelper(ArrayProperty, Data);
+
+		Node.bIsContainer = true;
+		Node.Children.Reserve(ArrayHelper.Num());
+
+		for (int32 Index = 0; Index < ArrayHelper.Num(); Index++)
+		{
+			FPropertyHistoryHashNode& Child = Node.Children.Add_GetRef(Build(*ArrayProperty->Inner, ArrayHelper.GetRawPtr(Index)));
+			Node.Hash = Combine(Node.Hash, Child.Hash);
+		}
+		Node.Hash = Combine(Node.Hash, ArrayHelper.Num());
+		return Node;
+	}
+
+	if (const FSetProperty* SetProperty = CastField<FSetProperty>(&Property))
+	{
+		FScriptSetHelper SetHelper(SetProperty, Data);
+
+		Node.bIsContainer = true;
+		Node.Children.Reserve(SetHelper.Num());
+
+		// Children are indexed like the details view does: by logical index, skipping holes
+		for (int32 LogicalIndex = 0; LogicalIndex < SetHelper.Num(); LogicalIndex++)
+		{
+			const int32 Index = SetHelper.FindInternalIndex(LogicalIndex);
+			FPropertyHistoryHashNode& Child = Node.Children.Add_GetRef(Build(*SetProperty->ElementProp, SetHelper.GetElementPtr(Index)));
+			Node.Hash = Combine(Node.Hash, Child.Hash);
+		}
+		Node.Hash = Combine(Node.Hash, SetHelper.Num());
+		return Node;
+	}
+
+	if (const FMapProperty* MapProperty = CastField<FMapProperty>(&Property))
+	{
+		FScriptMapHelper MapHelper(MapProperty, Data);
+
+		Node.bIsContainer = true;
+		Node.Children.Reserve(MapHelper.Num());
+
+		for (int32 LogicalIndex = 0; LogicalIndex < MapHelper.Num(); LogicalIndex++)
+		{
+			const int32 Index = MapHelper.FindInternalIndex(LogicalIndex);
+
+			// Pairs are shown as their value, with the key as name
+			FPropertyHistoryHashNode& Child = Node.Children.Add_GetRef(Build(*MapProperty->ValueProp, MapHelper.GetValuePtr(Index)));
+			Child.Hash = Combine(HashLeaf(*MapProperty->KeyProp, MapHelper.GetKeyPtr(Index)), Child.Hash);
+
+			Node.Hash = Combine(Node.Hash, Child.Hash);
+		}
+		Node.Hash = Combine(Node.Hash, MapHelper.Num());
+		return Node;
+	}
+
+	Node.Hash = HashLeaf(Property, Data);
+	return Node;
+}
+
+FPropertyHistoryHashNode FPropertyHistoryHashNode::BuildStruct(const UScriptStruct& Struct, const void* Data)
+{
+	FPropertyHistoryHashNode Node;
+	// Not the FName hash: trees are shared between processes through the shared cache, and FName indices differ between them
+	const FString StructPath = Struct.GetPathName();
+	Node.Hash = CityHash64(reinterpret_cast<const char*>(*StructPath), StructPath.Len() * sizeof(TCHAR));
+
+	for (const FProperty* Property : TFieldRange<FProperty>(&Struct))
+	{
+		FPropertyHistoryHashNode& Child = Node.Children.Add_GetRef(Build(*Property, Property->ContainerPtrToValuePtr<void>(Data)));
+		Child.Name = Property->GetFName();
+
+		Node.Hash = Combine(Node.Hash, Child.Hash);
+	}
+
+	return Node;
+}
+
+uint64 FPropertyHistoryHashNode::HashLeaf(const FProperty& Property, const void* Data)
+{
+	if (const FObjectPropertyBase* ObjectProperty = CastField<FObjectPropertyBase>(&Property))
+	{
+		const UObject* Object = ObjectProperty->GetObjectPropertyValue(Data);
+		if (!Object)
+		{
+			return 0;
+		}
+
+		// Each revision is loaded in its own package: only hash the path inside it, otherwise every subobject reference would differ
+		const UPackage* Package = Object->GetPackage();
+		const FString Path = FPropertyHistoryRevisionData::IsRevisionPackage(*Package)
+			? Object->GetPathName(Package)
+			: Object->GetPathName();
+
+		return CityHash64(reinterpret_cast<const char*>(*Path), Path.Len() * sizeof(TCHAR));
+	}
+
+	// Not GetValueTypeHash: it is only 32 bits, and ignores case for strings & names
+	// Fingerprints are used as value equality, they must only collide by accident of a 64 bit hash
+
+	if (const FBoolProperty* BoolProperty = CastField<FBoolProperty>(&Property))
+	{
+		// Bitfields share their byte with other fields
+		return BoolProperty->GetPropertyValue(Data) ? 1 : 0;
+	}
+
+	if (Property.HasAllPropertyFlags(CPF_IsPlainOldData))
+	{
+		return CityHash64(static_cast<const char*>(Data), Property.ElementSize);
+	}
+
+	// Case sensitive, and not relying on FName indices that differ between processes
+	FString Text;
+	Property.ExportText_Direct(Text, Data, Data, nullptr, PPF_None);
+	return CityHash64(reinterpret_cast<const char*>(*Text), Text.Len() * sizeof(TCHAR));
+}
+
+uint64 FPropertyHistoryHashNode::Combine(const uint64 A, const uint64 B)
+{
+	return CityHash128to64(Uint128_64(B, A));
+}
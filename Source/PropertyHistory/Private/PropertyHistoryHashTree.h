@@ -0,0 +1,39 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Merkle tree over a property value: one node per struct field, container element and map pair
+// Two values can be diffed by only descending into nodes whose hash differ
+// The root hash doubles as the fingerprint of the whole value
+struct FPropertyHistoryHashNode
+{
+	uint64 Hash = 0;
+	// Struct field this node is for, none for container elements
+	FName Name;
+	// If true children are container elements looked up by index, otherwise struct fields looked up by name
+	bool bIsContainer = false;
+	TArray<FPropertyHistoryHashNode> Children;
+
+	static FPropertyHistoryHashNode Build(const FProperty& Property, const void* Data);
+
+	const FPropertyHistoryHashNode* FindChild(int32 Index) const;
+	const FPropertyHistoryHashNode* FindChild(FName ChildName) const;
+
+	// Used to share hash trees through the shared cache
+	friend FArchive& operator<<(FArchive& Ar, FPropertyHistoryHashNode& Node)
+	{
+		Ar << Node.Hash;
+		Ar << Node.Name;
+		Ar << Node.bIsContainer;
+		Ar << Node.Children;
+		return Ar;
+	}
+
+private:
+	static FPropertyHistoryHashNode BuildValue(const FProperty& Property, const void* Data);
+	static FPropertyHistoryHashNode BuildStruct(const UScriptStruct& Struct, const void* Data);
+	static uint64 HashLeaf(const FProperty& Property, const void* Data);
+	static uint64 Combine(uint64 A, uint64 B);
+};
@@ -0,0 +1,35 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryMaterialExpressionChanges.h"
+#include "Materials/MaterialExpression.h"
+
+FText FPropertyHistoryMaterialExpressionChanges::GetTitle() const
+{
+	return FText::FromString(GetObjectName() + " History");
+}
+
+bool FPropertyHistoryMaterialExpressionChanges::ExtractValues(UObject& Object, TMap<FString, FValue>& OutValues) const
+{
+	const UMaterialExpression* MaterialExpression = Cast<UMaterialExpression>(&Object);
+	if (!MaterialExpression)
+	{
+		return false;
+	}
+
+	for (const FProperty* Property : TFieldRange<FProperty>(MaterialExpression->GetClass()))
+	{
+		if (!Property->HasAnyPropertyFlags(CPF_Edit) ||
+			Property->HasAnyPropertyFlags(CPF_Transient))
+		{
+			continue;
+		}
+
+		FString Value;
+		Property->ExportText_InContainer(0, Value, MaterialExpression, MaterialExpression, nullptr, PPF_None);
+
+		// Class might differ between revisions, key by name
+		OutValues.Add(Property->GetName(), FValue{ Property->GetDisplayNameText().ToString(), MoveTemp(Value) });
+	}
+
+	return true;
+}
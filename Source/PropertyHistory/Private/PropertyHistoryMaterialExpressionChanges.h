@@ -0,0 +1,20 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PropertyHistoryChangeTable.h"
+
+// Changes of all the editable properties of a material graph node
+class FPropertyHistoryMaterialExpressionChanges : public FPropertyHistoryChangeTable
+{
+public:
+	//~ Begin FPropertyHistoryChangeTable Interface
+	virtual FText GetTitle() const override;
+	//~ End FPropertyHistoryChangeTable Interface
+
+protected:
+	//~ Begin FPropertyHistoryChangeTable Interface
+	virtual bool ExtractValues(UObject& Object, TMap<FString, FValue>& OutValues) const override;
+	//~ End FPropertyHistoryChangeTable Interface
+};
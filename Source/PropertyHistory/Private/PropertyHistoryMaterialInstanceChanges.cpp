@@ -0,0 +1,82 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryMaterialInstanceChanges.h"
+#include "PropertyHistoryUtilities.h"
+#include "Materials/MaterialInstance.h"
+
+FText FPropertyHistoryMaterialInstanceChanges::GetTitle() const
+{
+	return FText::FromString(GetObjectName() + " Parameters History");
+}
+
+bool FPropertyHistoryMaterialInstanceChanges::ExtractValues(UObject& Object, TMap<FString, FValue>& OutValues) const
+{
+	const UMaterialInstance* MaterialInstance = Cast<UMaterialInstance>(&Object);
+	if (!MaterialInstance)
+	{
+		return false;
+	}
+
+	// One pass per parameter array: parameters are keyed by their expression guid
+	// Layer & blend parameters of the same layer function share their expression guid, they also need their association & index
+	const auto AddParameters = [&]<typename T>(
+		const TCHAR* Type,
+		const TArray<T>& Parameters,
+		const TConstArrayView<const FProperty*> ValueProperties)
+	{
+		for (const T& Parameter : Parameters)
+		{
+			const FMaterialParameterInfo& Info = Parameter.ParameterInfo;
+
+			FString Key = Type;
+			Key += ":";
+			Key += Parameter.ExpressionGUID.IsValid()
+				? Parameter.ExpressionGUID.ToString()
+				: Info.Name.ToString();
+			Key += FString::Printf(TEXT(".%d.%d"), int32(Info.Association), Info.Index);
+
+			FString Name = FString(Type) + " " + Info.Name.ToString();
+			if (Info.Association != GlobalParameter)
+			{
+				Name += FString::Printf(TEXT(" (%s %d)"), Info.Association == LayerParameter ? TEXT("Layer") : TEXT("Blend"), Info.Index);
+			}
+
+			FString Value;
+			for (const FProperty* ValueProperty : ValueProperties)
+			{
+				if (!Value.IsEmpty())
+				{
+					Value += ", ";
+				}
+				ValueProperty->ExportText_InContainer(0, Value, &Parameter, &Parameter, nullptr, PPF_None);
+			}
+
+			OutValues.Add(Key, FValue{ MoveTemp(Name), MoveTemp(Value) });
+		}
+	};
+
+	AddParameters(TEXT("Scalar"), MaterialInstance->ScalarParameterValues, { &FindFPropertyChecked(FScalarParameterValue, ParameterValue) });
+	AddParameters(TEXT("Vector"), MaterialInstance->VectorParameterValues, { &FindFPropertyChecked(FVectorParameterValue, ParameterValue) });
+	AddParameters(TEXT("DoubleVector"), MaterialInstance->DoubleVectorParameterValues, { &FindFPropertyChecked(FDoubleVectorParameterValue, ParameterValue) });
+	AddParameters(TEXT("Texture"), MaterialInstance->TextureParameterValues, { &FindFPropertyChecked(FTextureParameterValue, ParameterValue) });
+	AddParameters(TEXT("TextureCollection"), MaterialInstance->TextureCollectionParameterValues, { &FindFPropertyChecked(FTextureCollectionParameterValue, ParameterValue) });
+	AddParameters(TEXT("Font"), MaterialInstance->FontParameterValues,
+	{
+		&FindFPropertyChecked(FFontParameterValue, FontValue),
+		&FindFPropertyChecked(FFontParameterValue, FontPage)
+	});
+	AddParameters(TEXT("RuntimeVirtualTexture"), MaterialInstance->RuntimeVirtualTextureParameterValues, { &FindFPropertyChecked(FRuntimeVirtualTextureParameterValue, ParameterValue) });
+	AddParameters(TEXT("SparseVolumeTexture"), MaterialInstance->SparseVolumeTextureParameterValues, { &FindFPropertyChecked(FSparseVolumeTextureParameterValue, ParameterValue) });
+
+	const FStaticParameterSet StaticParameters = MaterialInstance->GetStaticParameters();
+	AddParameters(TEXT("StaticSwitch"), StaticParameters.StaticSwitchParameters, { &FindFPropertyChecked(FStaticSwitchParameter, Value) });
+	AddParameters(TEXT("StaticComponentMask"), StaticParameters.EditorOnly.StaticComponentMaskParameters,
+	{
+		&FindFPropertyChecked(FStaticComponentMaskParameter, R),
+		&FindFPropertyChecked(FStaticComponentMaskParameter, G),
+		&FindFPropertyChecked(FStaticComponentMaskParameter, B),
+		&FindFPropertyChecked(FStaticComponentMaskParameter, A)
+	});
+
+	return true;
+}
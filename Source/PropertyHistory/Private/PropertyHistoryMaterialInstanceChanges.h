@@ -0,0 +1,21 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PropertyHistoryChangeTable.h"
+
+// Changes of all the parameters of a material instance, including static switches and component masks
+// Parameters are tracked by expression guid, so that renamed parameters keep their history
+class FPropertyHistoryMaterialInstanceChanges : public FPropertyHistoryChangeTable
+{
+public:
+	//~ Begin FPropertyHistoryChangeTable Interface
+	virtual FText GetTitle() const override;
+	//~ End FPropertyHistoryChangeTable Interface
+
+protected:
+	//~ Begin FPropertyHistoryChangeTable Interface
+	virtual bool ExtractValues(UObject& Object, TMap<FString, FValue>& OutValues) const override;
+	//~ End FPropertyHistoryChangeTable Interface
+};
@@ -7,10 +7,25 @@
 #include "WorkspaceMenuStructure.h"
 #include "PropertyHistoryHandler.h"
 #include "PropertyHistoryProcessor.h"
+#include "PropertyHistoryMultiHandler.h"
+#include "PropertyHistoryChangeIndex.h"
+#include "PropertyHistoryMaterialInstanceChanges.h"
+#include "PropertyHistoryMaterialExpressionChanges.h"
+#include "PropertyHistoryDataTableChanges.h"
+#include "SPropertyHistoryChangeTable.h"
+#include "SPropertyHistoryMulti.h"
 #include "PropertyHistoryUtilities.h"
 #include "WorkspaceMenuStructureModule.h"
 #include "RevisionControlStyle/RevisionControlStyle.h"
+#include "MaterialEditor/MaterialEditorInstanceConstant.h"
+#include "Materials/MaterialInstanceConstant.h"
+#include "Materials/MaterialExpression.h"
+#include "Engine/DataTable.h"
+#include "PropertyEditorModule.h"
+#include "ISourceControlRevision.h"
 #include "Editor/PropertyEditor/Private/PropertyHandleImpl.h"
+#include "Editor/PropertyEditor/Private/DetailTreeNode.h"
+#include "Editor/PropertyEditor/Private/IDetailsViewPrivate.h"
 #include "Editor/PropertyEditor/Private/SDetailSingleItemRow.h"
 #include "Editor/PropertyEditor/Private/DetailRowMenuContextPrivate.h"
 
@@ -19,6 +34,11 @@ DEFINE_PRIVATE_ACCESS(SDetailsViewBase, DetailLayouts)
 DEFINE_PRIVATE_ACCESS(SDetailTableRowBase, OwnerTreeNode)
 DEFINE_PRIVATE_ACCESS_FUNCTION(SDetailSingleItemRow, GetPropertyNode);
 
+static TAutoConsoleVariable<bool> CVarPropertyHistoryShowLastChanged(
+	TEXT("PropertyHistory.ShowLastChanged"),
+	false,
+	TEXT("If true, details panels show when each property was last changed. Opt-in: the full history of every object shown is fetched & loaded in the background"));
+
 UClass* UDetailRowMenuContextPrivate::GetPrivateStaticClass()
 {
 	static UClass* Class = FindObjectChecked<UClass>(nullptr, TEXT("/Script/PropertyEditor.DetailRowMenuContextPrivate"));
@@ -26,85 +46,29 @@ UClass* UDetailRowMenuContextPrivate::GetPrivateStaticClass()
 	return Class;
 }
 
-class FPropertyHistoryModule : public IModuleInterface
+namespace PropertyHistoryModule
 {
-public:
-	virtual void StartupModule() override
+	// Property chain of a details row, built the same way for the context menu and the row buttons
+	struct FRowProperties
 	{
-		{
-			const TSharedRef<FGlobalTabmanager> TabManager = FGlobalTabmanager::Get();
+		// Innermost property first
+		TArray<FPropertyData> Properties;
+		FGuid PropertyGuid;
+		// Node the objects are read from
+		TSharedPtr<FPropertyNode> Node;
 
-			TabManager->RegisterNomadTabSpawner("PropertyHistoryTab", MakeLambdaDelegate([=](const FSpawnTabArgs& SpawnTabArgs)
-			{
-				return
-					SNew(SDockTab)
-					.TabRole(NomadTab)
-					.Label(INVTEXT("Property History"))
-					.ToolTipText(INVTEXT("Shows history of Property, using Source Control"))
-					[
-						SNew(SPropertyHistory)
-					];
-			}))
-			.SetDisplayName(INVTEXT("Property History"))
-			.SetIcon(FSlateIcon(FRevisionControlStyleManager::GetStyleSetName(), "RevisionControl.Actions.History"))
-			.SetGroup(WorkspaceMenu::GetMenuStructure().GetToolsCategory());
-		}
-
-		UToolMenu* Menu = UToolMenus::Get()->ExtendMenu(UE::PropertyEditor::RowContextMenuName);
+#if PROPERTY_HISTORY_ENGINE_VERSION >= 506
+		TSharedPtr<IDetailsView> DetailsView;
+#else
+		IDetailsView* DetailsView = nullptr;
+#endif
 
-		Menu->AddDynamicSection(NAME_None, MakeLambdaDelegate([](UToolMenu* ToolMenu)
+		// DetailsView must be set first: Voxel property chains are resolved through its layouts
+		bool Initialize(const TSharedRef<FPropertyNode>& RowNode)
 		{
-			const UDetailRowMenuContext* Context = ToolMenu->FindContext<UDetailRowMenuContext>();
-			const UDetailRowMenuContextPrivate* ContextPrivate = ToolMenu->FindContext<UDetailRowMenuContextPrivate>();
-			if (!Context ||
-				!ContextPrivate)
-			{
-				return;
-			}
-
-			const TSharedPtr<SDetailTableRowBase> RowBase = ContextPrivate->Row.Pin();
-			if (!RowBase)
-			{
-				return;
-			}
+			Node = RowNode;
 
-			const TSharedPtr<FDetailTreeNode> TreeNode = PrivateAccess::OwnerTreeNode(*RowBase).Pin();
-			if (!TreeNode ||
-				TreeNode->GetNodeType() != EDetailNodeType::Item)
-			{
-				return;
-			}
-
-			const TSharedPtr<SDetailSingleItemRow> Row = StaticCastSharedPtr<SDetailSingleItemRow>(RowBase);
-			if (!Row)
-			{
-				return;
-			}
-
-			TSharedPtr<FPropertyNode> Node = PrivateAccess::GetPropertyNode(*Row)();
-			if (!Node)
-			{
-				if (Context->PropertyHandles.Num() == 0)
-				{
-					return;
-				}
-
-				const TSharedPtr<FPropertyHandleBase> PropertyHandle = StaticCastSharedPtr<FPropertyHandleBase>(Context->PropertyHandles[0]);
-				if (!PropertyHandle)
-				{
-					return;
-				}
-
-				Node = PropertyHandle->GetPropertyNode();
-				if (!Node)
-				{
-					return;
-				}
-			}
-
-			TArray<FPropertyData> Properties;
 			FString PropertyChainString;
-			FGuid PropertyGuid;
 			{
 				TSharedPtr<FPropertyNode> LocalNode = Node;
 				while (LocalNode)
@@ -170,9 +134,9 @@ public:
 				{
 					const FPropertyData& RootProperty = Properties.Last();
 #if PROPERTY_HISTORY_ENGINE_VERSION >= 506
-					const TSharedPtr<SDetailsViewBase> DetailsViewBase = StaticCastSharedPtr<SDetailsViewBase>(Context->DetailsView.Pin());
+					const TSharedPtr<SDetailsViewBase> DetailsViewBase = StaticCastSharedPtr<SDetailsViewBase>(DetailsView);
 #else
-					SDetailsViewBase* DetailsViewBase = reinterpret_cast<SDetailsViewBase*>(Context->DetailsView);
+					SDetailsViewBase* DetailsViewBase = reinterpret_cast<SDetailsViewBase*>(DetailsView);
 #endif
 					const TSharedPtr<FPropertyNode> RootNode = INLINE_LAMBDA -> TSharedPtr<FPropertyNode>
 					{
@@ -211,62 +175,465 @@ public:
 				}
 			}
 
-			if (Properties.Num() == 0)
+			return Properties.Num() > 0;
+		}
+
+		TArray<UObject*> GetObjects() const
+		{
+			TArray<UObject*> Objects;
+
+			FReadAddressList ReadAddresses;
+			Node->GetReadAddress(false, ReadAddresses, false, false);
+
+			for (int32 Index = 0; Index < ReadAddresses.Num(); Index++)
 			{
-				return;
+				if (UObject* TargetObject = const_cast<UObject*>(ReadAddresses.GetObject(Index)))
+				{
+					Objects.AddUnique(TargetObject);
+				}
 			}
+			return Objects;
+		}
 
-			UObject* Object;
+		// Unset if the property is not one of that object, or its value can't be found
+		TOptional<FPropertyHistoryProcessor> MakeProcessor(UObject& Object) const
+		{
+			UClass* OwnerClass = Cast<UClass>(Properties.Last().Property->GetOwnerUObject());
+			if (!OwnerClass ||
+				!Object.IsA(OwnerClass))
 			{
-				FReadAddressList ReadAddresses;
-				const bool bAllValuesTheSame = Node->GetReadAddress(false, ReadAddresses, false, false);
-				if (ReadAddresses.Num() == 1 ||
-					(ReadAddresses.Num() > 0 && bAllValuesTheSame))
+				return {};
+			}
+
+			FPropertyHistoryProcessor Processor(&Object, Properties, PropertyGuid);
+			Processor.DetailsView = DetailsView;
+
+			void* Container = nullptr;
+			if (!Processor.Process(Container))
+			{
+				return {};
+			}
+			return Processor;
+		}
+	};
+}
+
+class FPropertyHistoryModule : public IModuleInterface
+{
+public:
+	virtual void StartupModule() override
+	{
+		{
+			const TSharedRef<FGlobalTabmanager> TabManager = FGlobalTabmanager::Get();
+
+			TabManager->RegisterNomadTabSpawner("PropertyHistoryTab", MakeLambdaDelegate([=](const FSpawnTabArgs& SpawnTabArgs)
+			{
+				return
+					SNew(SDockTab)
+					.TabRole(NomadTab)
+					.Label(INVTEXT("Property History"))
+					.ToolTipText(INVTEXT("Shows history of Property, using Source Control"))
+					[
+						SNew(SPropertyHistory)
+					];
+			}))
+			.SetDisplayName(INVTEXT("Property History"))
+			.SetIcon(FSlateIcon(FRevisionControlStyleManager::GetStyleSetName(), "RevisionControl.Actions.History"))
+			.SetGroup(WorkspaceMenu::GetMenuStructure().GetToolsCategory());
+		}
+
+		{
+			const TSharedRef<FGlobalTabmanager> TabManager = FGlobalTabmanager::Get();
+
+			TabManager->RegisterNomadTabSpawner("PropertyHistoryChangesTab", MakeLambdaDelegate([=](const FSpawnTabArgs& SpawnTabArgs)
+			{
+				return
+					SNew(SDockTab)
+					.TabRole(NomadTab)
+					.Label(INVTEXT("Changes History"))
+					.ToolTipText(INVTEXT("Shows every change of a set of values, using Source Control"))
+					[
+						SNew(SPropertyHistoryChangeTable)
+					];
+			}))
+			.SetDisplayName(INVTEXT("Changes History"))
+			.SetIcon(FSlateIcon(FRevisionControlStyleManager::GetStyleSetName(), "RevisionControl.Actions.History"))
+			.SetMenuType(ETabSpawnerMenuType::Hidden);
+		}
+
+		{
+			const TSharedRef<FGlobalTabmanager> TabManager = FGlobalTabmanager::Get();
+
+			TabManager->RegisterNomadTabSpawner("PropertyHistoryMultiTab", MakeLambdaDelegate([=](const FSpawnTabArgs& SpawnTabArgs)
+			{
+				return
+					SNew(SDockTab)
+					.TabRole(NomadTab)
+					.Label(INVTEXT("Selection History"))
+					.ToolTipText(INVTEXT("Shows history of Property on several objects, using Source Control"))
+					[
+						SNew(SPropertyHistoryMulti)
+					];
+			}))
+			.SetDisplayName(INVTEXT("Selection History"))
+			.SetIcon(FSlateIcon(FRevisionControlStyleManager::GetStyleSetName(), "RevisionControl.Actions.History"))
+			.SetMenuType(ETabSpawnerMenuType::Hidden);
+		}
+
+		{
+			FPropertyEditorModule& PropertyEditorModule = FModuleManager::LoadModuleChecked<FPropertyEditorModule>("PropertyEditor");
+
+			RowExtensionHandle = PropertyEditorModule.GetGlobalRowExtensionDelegate().AddLambda([](const FOnGenerateGlobalRowExtensionArgs& Args, TArray<FPropertyRowExtensionButton>& OutExtensions)
+			{
+				if (!CVarPropertyHistoryShowLastChanged.GetValueOnGameThread() ||
+					!Args.PropertyHandle)
+				{
+					return;
+				}
+
+				TArray<UObject*> Objects;
+				Args.PropertyHandle->GetOuterObjects(Objects);
+				if (Objects.Num() != 1 ||
+					!Objects[0])
+				{
+					return;
+				}
+
+				const TSharedRef<FPropertyHistoryValuePath> Path = MakeShared<FPropertyHistoryValuePath>();
+				if (!Path->Initialize(*Args.PropertyHandle))
+				{
+					return;
+				}
+
+				// Only starts streaming the history, never waits on it
+				// Only owned by the buttons of the rows: once the panel closes or shows another object, the index and its streams are released
+				const TSharedPtr<FPropertyHistoryChangeIndex> ChangeIndex = FPropertyHistoryChangeIndex::FindOrAdd(*Objects[0]);
+				if (!ChangeIndex)
 				{
-					Object = const_cast<UObject*>(ReadAddresses.GetObject(0));
+					return;
+				}
 
-					// Ensure that all objects are the same
-					for (int32 Index = 1; Index < ReadAddresses.Num(); Index++)
+				FPropertyRowExtensionButton& Button = OutExtensions.AddDefaulted_GetRef();
+				Button.Icon = FSlateIcon(FRevisionControlStyleManager::GetStyleSetName(), "RevisionControl.Actions.History");
+				Button.Label = INVTEXT("Last Changed");
+				Button.ToolTip = MakeAttributeLambda([=]
+				{
+					const TSharedPtr<ISourceControlRevision> LastChange = ChangeIndex->FindLastChange(*Path);
+					if (!LastChange)
 					{
-						const UObject* TargetObject = ReadAddresses.GetObject(Index);
-						if (Object != TargetObject)
+						return FText();
+					}
+
+					return FText::FromString(FString::Printf(TEXT("Last changed in %d by %s on %s\n%s\n\nClick to see history"),
+						LastChange->GetCheckInIdentifier(),
+						*LastChange->GetUserName(),
+						*LastChange->GetDate().ToString(),
+						*LastChange->GetDescription().TrimStartAndEnd()));
+				});
+
+				const TWeakPtr<IPropertyHandle> WeakPropertyHandle = Args.PropertyHandle;
+				const TWeakPtr<FDetailTreeNode> WeakTreeNode = Args.OwnerTreeNode;
+
+				Button.UIAction = FUIAction(
+					MakeLambdaDelegate([=]
+					{
+						const TSharedPtr<FPropertyHandleBase> PropertyHandle = StaticCastSharedPtr<FPropertyHandleBase>(WeakPropertyHandle.Pin());
+						const TSharedPtr<FDetailTreeNode> TreeNode = WeakTreeNode.Pin();
+						if (!PropertyHandle ||
+							!TreeNode)
 						{
 							return;
 						}
-					}
+
+						const TSharedPtr<FPropertyNode> Node = PropertyHandle->GetPropertyNode();
+						IDetailsViewPrivate* DetailsView = TreeNode->GetDetailsView();
+						if (!Node ||
+							!DetailsView)
+						{
+							return;
+						}
+
+						// Same chain as the context menu: property guids, Voxel property chains & material expressions need the details view
+						PropertyHistoryModule::FRowProperties RowProperties;
+#if PROPERTY_HISTORY_ENGINE_VERSION >= 506
+						RowProperties.DetailsView = StaticCastSharedRef<IDetailsView>(DetailsView->AsShared());
+#else
+						RowProperties.DetailsView = DetailsView;
+#endif
+						if (!RowProperties.Initialize(Node.ToSharedRef()))
+						{
+							return;
+						}
+
+						const TArray<UObject*> RowObjects = RowProperties.GetObjects();
+						if (RowObjects.Num() != 1)
+						{
+							return;
+						}
+
+						const TOptional<FPropertyHistoryProcessor> Processor = RowProperties.MakeProcessor(*RowObjects[0]);
+						if (!Processor)
+						{
+							return;
+						}
+
+						const TSharedRef<FPropertyHistoryHandler> Handler = MakeShared<FPropertyHistoryHandler>(Processor.GetValue());
+						if (Handler->Initialize(*Processor->Object))
+						{
+							Handler->ShowHistory();
+						}
+					}),
+					FCanExecuteAction(),
+					FIsActionChecked(),
+					MakeLambdaDelegate([=]
+					{
+						// Hidden until known, rows never wait on source control
+						return ChangeIndex->FindLastChange(*Path).IsValid();
+					}));
+			});
+		}
+
+		UToolMenu* Menu = UToolMenus::Get()->ExtendMenu(UE::PropertyEditor::RowContextMenuName);
+
+		Menu->AddDynamicSection(NAME_None, MakeLambdaDelegate([](UToolMenu* ToolMenu)
+		{
+			const UDetailRowMenuContext* Context = ToolMenu->FindContext<UDetailRowMenuContext>();
+			const UDetailRowMenuContextPrivate* ContextPrivate = ToolMenu->FindContext<UDetailRowMenuContextPrivate>();
+			if (!Context ||
+				!ContextPrivate)
+			{
+				return;
+			}
+
+			const TSharedPtr<SDetailTableRowBase> RowBase = ContextPrivate->Row.Pin();
+			if (!RowBase)
+			{
+				return;
+			}
+
+			const TSharedPtr<FDetailTreeNode> TreeNode = PrivateAccess::OwnerTreeNode(*RowBase).Pin();
+			if (!TreeNode ||
+				TreeNode->GetNodeType() != EDetailNodeType::Item)
+			{
+				return;
+			}
+
+			const TSharedPtr<SDetailSingleItemRow> Row = StaticCastSharedPtr<SDetailSingleItemRow>(RowBase);
+			if (!Row)
+			{
+				return;
+			}
+
+			TSharedPtr<FPropertyNode> Node = PrivateAccess::GetPropertyNode(*Row)();
+			if (!Node)
+			{
+				if (Context->PropertyHandles.Num() == 0)
+				{
+					return;
+				}
+
+				const TSharedPtr<FPropertyHandleBase> PropertyHandle = StaticCastSharedPtr<FPropertyHandleBase>(Context->PropertyHandles[0]);
+				if (!PropertyHandle)
+				{
+					return;
 				}
-				else
+
+				Node = PropertyHandle->GetPropertyNode();
+				if (!Node)
 				{
 					return;
 				}
 			}
 
-			if (!Object)
+			PropertyHistoryModule::FRowProperties RowProperties;
+#if PROPERTY_HISTORY_ENGINE_VERSION >= 506
+			RowProperties.DetailsView = Context->DetailsView.Pin();
+#else
+			RowProperties.DetailsView = Context->DetailsView;
+#endif
+			if (!RowProperties.Initialize(Node.ToSharedRef()))
 			{
 				return;
 			}
 
-			UClass* OwnerClass = Cast<UClass>(Properties.Last().Property->GetOwnerUObject());
-			if (!OwnerClass ||
-				!Object->IsA(OwnerClass))
+			const TArray<FPropertyData>& Properties = RowProperties.Properties;
+			const TArray<UObject*> SelectedObjects = RowProperties.GetObjects();
+
+			// Menus are built on every right click: entries only do in-memory checks
+			// Handlers & change tables find the package, its referencers and its streams once clicked
+			if (SelectedObjects.Num() > 1)
+			{
+				// Processed objects can differ from the selected ones, eg for material expressions
+				TArray<TPair<TWeakObjectPtr<UObject>, FPropertyHistoryProcessor>> Processors;
+				for (UObject* SelectedObject : SelectedObjects)
+				{
+					if (const TOptional<FPropertyHistoryProcessor> Processor = RowProperties.MakeProcessor(*SelectedObject))
+					{
+						Processors.Add({ Processor->Object, Processor.GetValue() });
+					}
+				}
+
+				if (Processors.Num() < 2)
+				{
+					return;
+				}
+
+				FToolMenuSection& Section = ToolMenu->FindOrAddSection("History", INVTEXT("History"));
+
+				Section.AddMenuEntry(
+					"SeeSelectionHistory",
+					INVTEXT("See history of selected objects"),
+					INVTEXT("See this property history on every selected object, side by side"),
+					FSlateIcon(FRevisionControlStyleManager::GetStyleSetName(), "RevisionControl.Actions.History"),
+					FUIAction(
+						MakeWeakObjectPtrDelegate(SelectedObjects[0], [Processors = MoveTemp(Processors)]
+						{
+							const TSharedRef<FPropertyHistoryMultiHandler> MultiHandler = MakeShared<FPropertyHistoryMultiHandler>();
+							for (const auto& It : Processors)
+							{
+								const FPropertyHistoryProcessor& Processor = It.Value;
+								if (!It.Key.IsValid())
+								{
+									continue;
+								}
+
+								// Objects of the same package end up on the same package stream
+								const TSharedRef<FPropertyHistoryHandler> Handler = MakeShared<FPropertyHistoryHandler>(Processor);
+								if (!Handler->Initialize(*Processor.Object))
+								{
+									continue;
+								}
+
+								MultiHandler->AddObject(*Processor.Object, Handler);
+							}
+
+							if (MultiHandler->NumObjects() > 0)
+							{
+								MultiHandler->ShowHistory();
+							}
+						})));
+				return;
+			}
+
+			if (SelectedObjects.Num() == 0)
 			{
+				// Data table rows are edited as bare structs, outside of any object
+				const FProperty* RootProperty = Properties.Last().Property;
+				const UScriptStruct* RowStruct = RootProperty->GetOwner<UScriptStruct>();
+				if (!RowStruct ||
+					!RowStruct->IsChildOf(FTableRowBase::StaticStruct()))
+				{
+					return;
+				}
+
+				FReadAddressList ReadAddresses;
+				RowProperties.Node->GetReadAddress(false, ReadAddresses, false, false);
+				if (ReadAddresses.Num() != 1)
+				{
+					return;
+				}
+
+				FName RowName;
+				UDataTable* DataTable = FPropertyHistoryDataTableRevision::FindEditedRow(
+					*RowStruct,
+					ReadAddresses.GetAddress(0) - RootProperty->GetOffset_ForInternal(),
+					RowName);
+				if (!DataTable)
+				{
+					return;
+				}
+
+				FToolMenuSection& Section = ToolMenu->FindOrAddSection("History", INVTEXT("History"));
+
+				Section.AddMenuEntry(
+					"SeeRowHistory",
+					INVTEXT("See row history"),
+					INVTEXT("See every change of this data table row, following it by name"),
+					FSlateIcon(FRevisionControlStyleManager::GetStyleSetName(), "RevisionControl.Actions.History"),
+					FUIAction(
+						MakeWeakObjectPtrDelegate(DataTable, [DataTable, RowName]
+						{
+							const TSharedRef<FPropertyHistoryDataTableRowChanges> RowChanges = MakeShared<FPropertyHistoryDataTableRowChanges>(RowName);
+							if (RowChanges->Initialize(*DataTable))
+							{
+								RowChanges->ShowHistory();
+							}
+						})));
+
+				Section.AddMenuEntry(
+					"SeeColumnHistory",
+					INVTEXT("See column history"),
+					INVTEXT("See every change of this property across all the rows of the data table"),
+					FSlateIcon(FRevisionControlStyleManager::GetStyleSetName(), "RevisionControl.Actions.History"),
+					FUIAction(
+						MakeWeakObjectPtrDelegate(DataTable, [DataTable, ColumnName = RootProperty->GetFName()]
+						{
+							const TSharedRef<FPropertyHistoryDataTableColumnChanges> ColumnChanges = MakeShared<FPropertyHistoryDataTableColumnChanges>(ColumnName);
+							if (ColumnChanges->Initialize(*DataTable))
+							{
+								ColumnChanges->ShowHistory();
+							}
+						})));
 				return;
 			}
 
-			FPropertyHistoryProcessor Processor(Object, Properties, PropertyGuid);
+			UObject* Object = SelectedObjects[0];
+
+			if (const UMaterialEditorInstanceConstant* MaterialEditorInstance = Cast<UMaterialEditorInstanceConstant>(Object))
+			{
+				if (UMaterialInstanceConstant* SourceInstance = MaterialEditorInstance->SourceInstance)
+				{
+					FToolMenuSection& Section = ToolMenu->FindOrAddSection("History", INVTEXT("History"));
+
+					Section.AddMenuEntry(
+						"SeeParametersHistory",
+						INVTEXT("See all parameters history"),
+						INVTEXT("See every parameter change of this material instance"),
+						FSlateIcon(FRevisionControlStyleManager::GetStyleSetName(), "RevisionControl.Actions.History"),
+						FUIAction(
+							MakeWeakObjectPtrDelegate(SourceInstance, [SourceInstance]
+							{
+								const TSharedRef<FPropertyHistoryMaterialInstanceChanges> Changes = MakeShared<FPropertyHistoryMaterialInstanceChanges>();
+								if (Changes->Initialize(*SourceInstance))
+								{
+									Changes->ShowHistory();
+								}
+							})));
+				}
+			}
+
+			if (const UMaterialExpression* MaterialExpression = Cast<UMaterialExpression>(Object))
+			{
 #if PROPERTY_HISTORY_ENGINE_VERSION >= 506
-			Processor.DetailsView = Context->DetailsView.Pin();
+				const TSharedPtr<IDetailsView> DetailsView = Context->DetailsView.Pin();
+				UMaterialExpression* OriginalMaterialExpression = FPropertyHistoryProcessor::FindOriginalMaterialExpression(*MaterialExpression, DetailsView.Get());
 #else
-			Processor.DetailsView = Context->DetailsView;
+				UMaterialExpression* OriginalMaterialExpression = FPropertyHistoryProcessor::FindOriginalMaterialExpression(*MaterialExpression, Context->DetailsView);
 #endif
-			void* Container = nullptr;
-			if (!Processor.Process(Container))
-			{
-				return;
+
+				if (OriginalMaterialExpression)
+				{
+					FToolMenuSection& Section = ToolMenu->FindOrAddSection("History", INVTEXT("History"));
+
+					Section.AddMenuEntry(
+						"SeeNodeHistory",
+						INVTEXT("See node history"),
+						INVTEXT("See every property change of this material node"),
+						FSlateIcon(FRevisionControlStyleManager::GetStyleSetName(), "RevisionControl.Actions.History"),
+						FUIAction(
+							MakeWeakObjectPtrDelegate(OriginalMaterialExpression, [OriginalMaterialExpression]
+							{
+								const TSharedRef<FPropertyHistoryMaterialExpressionChanges> Changes = MakeShared<FPropertyHistoryMaterialExpressionChanges>();
+								if (Changes->Initialize(*OriginalMaterialExpression))
+								{
+									Changes->ShowHistory();
+								}
+							})));
+				}
 			}
 
-			const TSharedRef<FPropertyHistoryHandler> Handler = MakeShared<FPropertyHistoryHandler>(Processor);
-			if (!Handler->Initialize(*Processor.Object))
+			const TOptional<FPropertyHistoryProcessor> Processor = RowProperties.MakeProcessor(*Object);
+			if (!Processor)
 			{
 				return;
 			}
@@ -279,9 +646,13 @@ public:
 				INVTEXT("See this property history"),
 				FSlateIcon(FRevisionControlStyleManager::GetStyleSetName(), "RevisionControl.Actions.History"),
 				FUIAction(
-					MakeWeakObjectPtrDelegate(Object, [Handler]
+					MakeWeakObjectPtrDelegate(Processor->Object, [Processor = Processor.GetValue()]
 					{
-						Handler->ShowHistory();
+						const TSharedRef<FPropertyHistoryHandler> Handler = MakeShared<FPropertyHistoryHandler>(Processor);
+						if (Handler->Initialize(*Processor.Object))
+						{
+							Handler->ShowHistory();
+						}
 					})));
 		}));
 	}
@@ -289,7 +660,17 @@ public:
 	{
 		const TSharedRef<FGlobalTabmanager> TabManager = FGlobalTabmanager::Get();
 		TabManager->UnregisterNomadTabSpawner("PropertyHistoryTab");
+		TabManager->UnregisterNomadTabSpawner("PropertyHistoryChangesTab");
+		TabManager->UnregisterNomadTabSpawner("PropertyHistoryMultiTab");
+
+		if (FPropertyEditorModule* PropertyEditorModule = FModuleManager::GetModulePtr<FPropertyEditorModule>("PropertyEditor"))
+		{
+			PropertyEditorModule->GetGlobalRowExtensionDelegate().Remove(RowExtensionHandle);
+		}
 	}
+
+private:
+	FDelegateHandle RowExtensionHandle;
 };
 
 IMPLEMENT_MODULE(FPropertyHistoryModule, PropertyHistory);
\ No newline at end of file
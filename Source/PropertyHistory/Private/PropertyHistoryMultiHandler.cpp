@@ -0,0 +1,178 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryMultiHandler.h"
+#include "SPropertyHistoryMulti.h"
+#include "ISourceControlRevision.h"
+#include "GameFramework/Actor.h"
+#include "Algo/StableSort.h"
+
+void FPropertyHistoryMultiHandler::AddObject(const UObject& Object, const TSharedRef<FPropertyHistoryHandler>& Handler)
+{
+	check(!bSubscribed);
+
+	Handlers.Add(Handler);
+
+	// Actors are known by their label, components by their actor label too
+	if (const AActor* Actor = Cast<AActor>(&Object))
+	{
+		ObjectNames.Add(Actor->GetActorLabel());
+	}
+	else if (const AActor* OwnerActor = Object.GetTypedOuter<AActor>())
+	{
+		ObjectNames.Add(OwnerActor->GetActorLabel() + "." + Object.GetName());
+	}
+	else
+	{
+		ObjectNames.Add(Object.GetName());
+	}
+}
+
+void FPropertyHistoryMultiHandler::ShowHistory()
+{
+	const TSharedPtr<SDockTab> NewTab = FGlobalTabmanager::Get()->TryInvokeTab(FName("PropertyHistoryMultiTab"));
+	if (!ensure(NewTab))
+	{
+		return;
+	}
+
+	const TSharedRef<SPropertyHistoryMulti> MultiWidget = StaticCastSharedRef<SPropertyHistoryMulti>(NewTab->GetContent());
+	MultiWidget->SetHandler(AsShared());
+
+	FSlateApplication::Get().SetKeyboardFocus(MultiWidget, EFocusCause::SetDirectly);
+
+	if (bSubscribed)
+	{
+		return;
+	}
+	bSubscribed = true;
+
+	// No handler is made priority: streams of different packages all load at the same time
+	for (const TSharedRef<FPropertyHistoryHandler>& Handler : Handlers)
+	{
+		Handler->OnNewEntry.AddSP(this, &FPropertyHistoryMultiHandler::RebuildRows);
+		Handler->OnStateChanged.AddSPLambda(this, [this]
+		{
+			OnStateChanged.Broadcast();
+		});
+		Handler->Subscribe();
+	}
+
+	RebuildRows();
+}
+
+void FPropertyHistoryMultiHandler::Cancel()
+{
+	if (!bSubscribed)
+	{
+		return;
+	}
+	bSubscribed = false;
+
+	for (const TSharedRef<FPropertyHistoryHandler>& Handler : Handlers)
+	{
+		Handler->OnNewEntry.RemoveAll(this);
+		Handler->OnStateChanged.RemoveAll(this);
+		Handler->Cancel();
+	}
+
+	OnStateChanged.Broadcast();
+}
+
+bool FPropertyHistoryMultiHandler::IsLoading() const
+{
+	if (!bSubscribed)
+	{
+		return false;
+	}
+
+	for (const TSharedRef<FPropertyHistoryHandler>& Handler : Handlers)
+	{
+		if (Handler->IsLoading())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+TOptional<FString> FPropertyHistoryMultiHandler::GetError() const
+{
+	TOptional<FString> Error;
+	for (int32 Index = 0; Index < Handlers.Num(); Index++)
+	{
+		const TOptional<FString>& HandlerError = Handlers[Index]->GetError();
+		if (!HandlerError.IsSet())
+		{
+			continue;
+		}
+
+		const FString NewError = ObjectNames[Index] + ": " + HandlerError.GetValue();
+		Error = Error.IsSet() ? Error.GetValue() + "\n" + NewError : NewError;
+	}
+	return Error;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FPropertyHistoryMultiHandler::RebuildRows()
+{
+	const int32 NumHandlers = Handlers.Num();
+
+	TArray<TSharedPtr<FPropertyHistoryMultiRow>> NewRows;
+	TMap<FString, TSharedPtr<FPropertyHistoryMultiRow>> KeyToRow;
+
+	for (int32 Index = 0; Index < NumHandlers; Index++)
+	{
+		for (const TSharedPtr<FPropertyHistoryEntry>& Entry : Handlers[Index]->Entries)
+		{
+			const ISourceControlRevision& Revision = *Entry->Revision;
+
+			// Packages have their own revisions, even when they were submitted together
+			const FString Key = Revision.GetCheckInIdentifier() != 0
+				? FString::FromInt(Revision.GetCheckInIdentifier())
+				: Revision.GetFilename() + "#" + Revision.GetRevision();
+
+			TSharedPtr<FPropertyHistoryMultiRow>& Row = KeyToRow.FindOrAdd(Key);
+			if (!Row)
+			{
+				Row = MakeShared<FPropertyHistoryMultiRow>();
+				Row->Revision = Entry->Revision;
+				Row->Values.SetNum(NumHandlers);
+				Row->Changed.Init(false, NumHandlers);
+				NewRows.Add(Row);
+			}
+
+			Row->Values[Index] = Entry->Value;
+			Row->Changed[Index] = true;
+		}
+	}
+
+	Algo::StableSort(NewRows, [](const TSharedPtr<FPropertyHistoryMultiRow>& A, const TSharedPtr<FPropertyHistoryMultiRow>& B)
+	{
+		return A->Revision->GetDate() > B->Revision->GetDate();
+	});
+
+	// Objects that did not change in a revision keep their previous value
+	TArray<TSharedPtr<FPropertyHistoryValue>> CurrentValues;
+	CurrentValues.SetNum(NumHandlers);
+
+	for (const TSharedPtr<FPropertyHistoryMultiRow>& Row : ReverseIterate(NewRows))
+	{
+		for (int32 Index = 0; Index < NumHandlers; Index++)
+		{
+			if (Row->Changed[Index])
+			{
+				CurrentValues[Index] = Row->Values[Index];
+			}
+			else
+			{
+				Row->Values[Index] = CurrentValues[Index];
+			}
+		}
+	}
+
+	Rows = MoveTemp(NewRows);
+	OnRowsUpdated.Broadcast();
+}
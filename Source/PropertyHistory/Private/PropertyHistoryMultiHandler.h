@@ -0,0 +1,53 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PropertyHistoryHandler.h"
+
+struct FPropertyHistoryMultiRow
+{
+	TSharedPtr<ISourceControlRevision> Revision;
+	// One per object: its value as of this revision, null if it has no history yet
+	TArray<TSharedPtr<FPropertyHistoryValue>> Values;
+	// One per object: true if its value changed in this revision
+	TBitArray<> Changed;
+};
+
+// History of the same property on several objects, eg a selection of actors
+// Each object has its own handler: objects in the same package share their package stream,
+// and objects in different packages are streamed independently
+class FPropertyHistoryMultiHandler : public TSharedFromThis<FPropertyHistoryMultiHandler>
+{
+public:
+	FSimpleMulticastDelegate OnRowsUpdated;
+	FSimpleMulticastDelegate OnStateChanged;
+	// Newest revision first, only revisions changing at least one object
+	TArray<TSharedPtr<FPropertyHistoryMultiRow>> Rows;
+
+public:
+	FPropertyHistoryMultiHandler() = default;
+
+	void AddObject(const UObject& Object, const TSharedRef<FPropertyHistoryHandler>& Handler);
+	void ShowHistory();
+	void Cancel();
+
+	bool IsLoading() const;
+	TOptional<FString> GetError() const;
+
+	int32 NumObjects() const
+	{
+		return Handlers.Num();
+	}
+	const TArray<FString>& GetObjectNames() const
+	{
+		return ObjectNames;
+	}
+
+private:
+	TArray<TSharedRef<FPropertyHistoryHandler>> Handlers;
+	TArray<FString> ObjectNames;
+	bool bSubscribed = false;
+
+	void RebuildRows();
+};
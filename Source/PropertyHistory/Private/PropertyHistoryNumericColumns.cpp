@@ -0,0 +1,212 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryNumericColumns.h"
+
+namespace PropertyHistoryNumericColumns
+{
+	bool IsNumber(const FProperty& Property)
+	{
+		if (Property.ArrayDim != 1)
+		{
+			return false;
+		}
+
+		if (Property.IsA<FBoolProperty>())
+		{
+			return true;
+		}
+
+		const FNumericProperty* NumericProperty = CastField<FNumericProperty>(&Property);
+		return
+			NumericProperty &&
+			// Byte enums
+			!NumericProperty->IsEnum();
+	}
+
+	double ReadNumber(const FProperty& Property, const void* Data)
+	{
+		if (const FBoolProperty* BoolProperty = CastField<FBoolProperty>(&Property))
+		{
+			return BoolProperty->GetPropertyValue(Data) ? 1. : 0.;
+		}
+
+		const FNumericProperty& NumericProperty = *CastFieldChecked<FNumericProperty>(&Property);
+		return NumericProperty.IsFloatingPoint()
+			? NumericProperty.GetFloatingPointPropertyValue(Data)
+			: double(NumericProperty.GetSignedIntPropertyValue(Data));
+	}
+
+	template<typename VectorCompareType, typename ScalarCompareType>
+	void Compare(
+		const TConstArrayView<double> Values,
+		const double Threshold,
+		TBitArray<>& InOutMatches,
+		VectorCompareType VectorCompare,
+		ScalarCompareType ScalarCompare)
+	{
+		const double* Data = Values.GetData();
+		const int32 Num = Values.Num();
+		const VectorRegister4Double ThresholdVector = VectorSetFloat1(Threshold);
+
+		int32 Index = 0;
+		for (; Index + 4 <= Num; Index += 4)
+		{
+			const uint32 Mask = VectorMaskBits(VectorCompare(VectorLoad(Data + Index), ThresholdVector));
+			if (Mask == 0)
+			{
+				continue;
+			}
+
+			for (int32 Lane = 0; Lane < 4; Lane++)
+			{
+				if (Mask & (1 << Lane))
+				{
+					InOutMatches[Index + Lane] = true;
+				}
+			}
+		}
+
+		for (; Index < Num; Index++)
+		{
+			if (ScalarCompare(Data[Index], Threshold))
+			{
+				InOutMatches[Index] = true;
+			}
+		}
+	}
+}
+
+bool FPropertyHistoryNumericColumns::Initialize(const FProperty& Property)
+{
+	Channels.Reset();
+	NumRows = 0;
+
+	if (PropertyHistoryNumericColumns::IsNumber(Property))
+	{
+		Channels.Add(FChannel{ Property.GetFName(), &Property, 0 });
+		return true;
+	}
+
+	const FStructProperty* StructProperty = CastField<FStructProperty>(&Property);
+	if (!StructProperty ||
+		Property.ArrayDim != 1)
+	{
+		return false;
+	}
+
+	for (TFieldIterator<FProperty> It(StructProperty->Struct); It; ++It)
+	{
+		if (Channels.Num() == MaxChannels ||
+			!PropertyHistoryNumericColumns::IsNumber(**It))
+		{
+			Channels.Reset();
+			return false;
+		}
+
+		Channels.Add(FChannel{ It->GetFName(), *It, It->GetOffset_ForInternal() });
+	}
+
+	return Channels.Num() > 0;
+}
+
+int32 FPropertyHistoryNumericColumns::AddRow(const void* Data)
+{
+	for (FChannel& Channel : Channels)
+	{
+		Channel.Values.Add(PropertyHistoryNumericColumns::ReadNumber(*Channel.Property, static_cast<const uint8*>(Data) + Channel.Offset));
+	}
+	return NumRows++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FPropertyHistoryNumericColumns::GetRange(const TConstArrayView<double> Values, double& InOutMin, double& InOutMax)
+{
+	const double* Data = Values.GetData();
+	const int32 Num = Values.Num();
+
+	VectorRegister4Double Min = VectorSetFloat1(InOutMin);
+	VectorRegister4Double Max = VectorSetFloat1(InOutMax);
+
+	int32 Index = 0;
+	for (; Index + 4 <= Num; Index += 4)
+	{
+		// NaN handling of min & max differs between SSE & NEON: NaN lanes are replaced by the current range instead
+		const VectorRegister4Double Value = VectorLoad(Data + Index);
+		const VectorRegister4Double IsNumber = VectorCompareEQ(Value, Value);
+		Min = VectorMin(VectorSelect(IsNumber, Value, Min), Min);
+		Max = VectorMax(VectorSelect(IsNumber, Value, Max), Max);
+	}
+
+	double Mins[4];
+	double Maxs[4];
+	VectorStore(Min, Mins);
+	VectorStore(Max, Maxs);
+
+	for (int32 Lane = 0; Lane < 4; Lane++)
+	{
+		InOutMin = FMath::Min(InOutMin, Mins[Lane]);
+		InOutMax = FMath::Max(InOutMax, Maxs[Lane]);
+	}
+
+	for (; Index < Num; Index++)
+	{
+		if (!FMath::IsNaN(Data[Index]))
+		{
+			InOutMin = FMath::Min(InOutMin, Data[Index]);
+			InOutMax = FMath::Max(InOutMax, Data[Index]);
+		}
+	}
+}
+
+void FPropertyHistoryNumericColumns::Compare(
+	const TConstArrayView<double> Values,
+	const EPropertyHistoryComparison Comparison,
+	const double Threshold,
+	TBitArray<>& InOutMatches)
+{
+	check(InOutMatches.Num() == Values.Num());
+
+	// One loop per comparison, so that the compare is not branched on per value
+	switch (Comparison)
+	{
+	case EPropertyHistoryComparison::Equal:
+	{
+		PropertyHistoryNumericColumns::Compare(Values, Threshold, InOutMatches,
+			[](const VectorRegister4Double& A, const VectorRegister4Double& B) { return VectorCompareEQ(A, B); },
+			[](const double A, const double B) { return A == B; });
+		break;
+	}
+	case EPropertyHistoryComparison::Less:
+	{
+		PropertyHistoryNumericColumns::Compare(Values, Threshold, InOutMatches,
+			[](const VectorRegister4Double& A, const VectorRegister4Double& B) { return VectorCompareLT(A, B); },
+			[](const double A, const double B) { return A < B; });
+		break;
+	}
+	case EPropertyHistoryComparison::LessEqual:
+	{
+		PropertyHistoryNumericColumns::Compare(Values, Threshold, InOutMatches,
+			[](const VectorRegister4Double& A, const VectorRegister4Double& B) { return VectorCompareLE(A, B); },
+			[](const double A, const double B) { return A <= B; });
+		break;
+	}
+	case EPropertyHistoryComparison::Greater:
+	{
+		PropertyHistoryNumericColumns::Compare(Values, Threshold, InOutMatches,
+			[](const VectorRegister4Double& A, const VectorRegister4Double& B) { return VectorCompareGT(A, B); },
+			[](const double A, const double B) { return A > B; });
+		break;
+	}
+	case EPropertyHistoryComparison::GreaterEqual:
+	{
+		PropertyHistoryNumericColumns::Compare(Values, Threshold, InOutMatches,
+			[](const VectorRegister4Double& A, const VectorRegister4Double& B) { return VectorCompareGE(A, B); },
+			[](const double A, const double B) { return A >= B; });
+		break;
+	}
+	default: ensure(false);
+	}
+}
@@ -0,0 +1,66 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EPropertyHistoryComparison : uint8
+{
+	Equal,
+	Less,
+	LessEqual,
+	Greater,
+	GreaterEqual
+};
+
+// Numeric values of a history stored column-wise: one contiguous array of doubles per channel, eg X, Y & Z of a vector
+// Numbers & bools are a single channel, structs whose fields are all numbers one channel per field, eg FVector, FLinearColor or FRotator
+// Rows are added straight from the memory of a revision, without going through a bag
+class FPropertyHistoryNumericColumns
+{
+public:
+	static constexpr int32 MaxChannels = 4;
+
+	// False if the property is not numeric, eg an enum or a struct with a string field
+	bool Initialize(const FProperty& Property);
+
+	int32 Num() const
+	{
+		return NumRows;
+	}
+	int32 NumChannels() const
+	{
+		return Channels.Num();
+	}
+	FName GetChannelName(const int32 Channel) const
+	{
+		return Channels[Channel].Name;
+	}
+	TConstArrayView<double> GetColumn(const int32 Channel) const
+	{
+		return Channels[Channel].Values;
+	}
+
+	// Data is the value of the property. Returns the new row
+	int32 AddRow(const void* Data);
+
+public:
+	// Kernels over whole columns, four values per instruction
+
+	// Min & max of the values, NaNs are ignored
+	static void GetRange(TConstArrayView<double> Values, double& InOutMin, double& InOutMax);
+	// Sets the bit of every value matching, NaNs never match
+	static void Compare(TConstArrayView<double> Values, EPropertyHistoryComparison Comparison, double Threshold, TBitArray<>& InOutMatches);
+
+private:
+	struct FChannel
+	{
+		FName Name;
+		// Numeric or bool
+		const FProperty* Property = nullptr;
+		int32 Offset = 0;
+		TArray<double> Values;
+	};
+	TArray<FChannel, TInlineAllocator<MaxChannels>> Channels;
+	int32 NumRows = 0;
+};
@@ -0,0 +1,266 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryObjectPath.h"
+#include "SourceControlHelpers.h"
+#include "PropertyHistoryProcessor.h"
+#include "PropertyHistoryPackageStream.h"
+#include "GameFramework/Actor.h"
+#include "Engine/Level.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialExpression.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "AssetRegistry/IAssetRegistry.h"
+
+namespace PropertyHistoryObjectPath
+{
+	// Scanning referencers is slow on large projects, and every handler & change index of a package needs it
+	// Cleared whenever a redirector might have been added or removed
+	TMap<FName, TArray<FString>> PackageToRedirectorPackageFilenames;
+
+	const TArray<FString>& FindRedirectorPackageFilenames(IAssetRegistry& AssetRegistry, const FName PackageName)
+	{
+		static bool bSubscribed = false;
+		if (!bSubscribed)
+		{
+			bSubscribed = true;
+
+			AssetRegistry.OnAssetRenamed().AddLambda([](const FAssetData&, const FString&)
+			{
+				PackageToRedirectorPackageFilenames.Reset();
+			});
+			AssetRegistry.OnAssetAdded().AddLambda([](const FAssetData& AssetData)
+			{
+				if (AssetData.IsRedirector())
+				{
+					PackageToRedirectorPackageFilenames.Reset();
+				}
+			});
+			AssetRegistry.OnAssetRemoved().AddLambda([](const FAssetData& AssetData)
+			{
+				if (AssetData.IsRedirector())
+				{
+					PackageToRedirectorPackageFilenames.Reset();
+				}
+			});
+		}
+
+		if (const TArray<FString>* RedirectorPackageFilenames = PackageToRedirectorPackageFilenames.Find(PackageName))
+		{
+			return *RedirectorPackageFilenames;
+		}
+
+		TArray<FString> RedirectorPackageFilenames;
+
+		TArray<FName> Referencers;
+		AssetRegistry.GetReferencers(PackageName, Referencers);
+
+		for (const FName Referencer : Referencers)
+		{
+			TArray<FAssetData> Assets;
+			AssetRegistry.GetAssetsByPackageName(Referencer, Assets);
+
+			if (Assets.Num() != 1 ||
+				!Assets[0].IsRedirector())
+			{
+				continue;
+			}
+
+			RedirectorPackageFilenames.Append(SourceControlHelpers::PackageFilenames({ Referencer.ToString() }));
+		}
+
+		return PackageToRedirectorPackageFilenames.Add(PackageName, MoveTemp(RedirectorPackageFilenames));
+	}
+
+	// Null if the package is a map or has several assets: a renamed asset can't be told apart from the others
+	UObject* FindOnlyAsset(const UPackage& Package)
+	{
+		if (Package.ContainsMap())
+		{
+			return nullptr;
+		}
+
+		UObject* Asset = nullptr;
+		bool bSeveralAssets = false;
+		ForEachObjectWithPackage(&Package, [&](UObject* Object)
+		{
+			if (!Object->IsAsset())
+			{
+				return true;
+			}
+
+			if (Asset)
+			{
+				bSeveralAssets = true;
+				return false;
+			}
+
+			Asset = Object;
+			return true;
+		}, false);
+
+		return bSeveralAssets ? nullptr : Asset;
+	}
+}
+
+bool FPropertyHistoryObjectPath::Initialize(const UObject& Object)
+{
+	{
+		const UObject* CurrentObject = &Object;
+		OuterChain.Add(CurrentObject);
+
+		while (
+			!CurrentObject->IsA<UPackage>() &&
+			!CurrentObject->IsPackageExternal())
+		{
+			CurrentObject = CurrentObject->GetOuter();
+
+			if (!CurrentObject)
+			{
+				return false;
+			}
+
+			OuterChain.Add(CurrentObject);
+		}
+	}
+
+	// Also handles UPackage
+	const UPackage* Package = OuterChain.Last()->GetExternalPackage();
+	if (!ensure(Package))
+	{
+		return false;
+	}
+
+	const FString PackageName = Package->GetName();
+	const TArray<FString> PackageFilenames = SourceControlHelpers::PackageFilenames({ PackageName });
+
+	if (!ensure(PackageFilenames.Num() == 1))
+	{
+		return false;
+	}
+
+	PackageFilename = PackageFilenames[0];
+
+	if (OuterChain.Last()->IsA<UPackage>())
+	{
+		// Only uses the asset registry, redirector packages are not loaded until their history is
+		RedirectorPackageFilenames = PropertyHistoryObjectPath::FindRedirectorPackageFilenames(IAssetRegistry::GetChecked(), Package->GetFName());
+
+		bFollowAssetRenames =
+			OuterChain.Num() >= 2 &&
+			PropertyHistoryObjectPath::FindOnlyAsset(*Package) == OuterChain.Last(1).Get();
+	}
+
+	if (const UMaterialExpression* MaterialExpression = Cast<UMaterialExpression>(&Object))
+	{
+		MaterialExpressionGuid = MaterialExpression->MaterialExpressionGuid;
+	}
+
+	if (Object.HasAnyFlags(RF_ClassDefaultObject) &&
+		OuterChain.Num() == 2 &&
+		Object.GetClass()->IsA<UBlueprintGeneratedClass>())
+	{
+		DefaultsClass = Object.GetClass();
+	}
+
+	// Outermost actor, eg the actor owning a component
+	for (int32 Index = OuterChain.Num() - 1; Index >= 0; Index--)
+	{
+		const AActor* Actor = Cast<AActor>(OuterChain[Index].Get());
+		if (!Actor ||
+			!Actor->GetActorGuid().IsValid())
+		{
+			continue;
+		}
+
+		ActorGuid = Actor->GetActorGuid();
+		ActorIndex = Index;
+
+		if (Actor->IsPackageExternal())
+		{
+			if (const ULevel* Level = Actor->GetLevel())
+			{
+				const TArray<FString> LevelPackageFilenames = SourceControlHelpers::PackageFilenames({ Level->GetPackage()->GetName() });
+				if (LevelPackageFilenames.Num() == 1)
+				{
+					LevelPackageFilename = LevelPackageFilenames[0];
+				}
+			}
+		}
+		break;
+	}
+
+	return true;
+}
+
+UObject* FPropertyHistoryObjectPath::Resolve(const FPropertyHistoryRevision& Revision) const
+{
+	if (!Revision.Package)
+	{
+		return nullptr;
+	}
+
+	UObject* Object = Revision.Package;
+	for (int32 Index = OuterChain.Num() - 1; Index >= 0; Index--)
+	{
+		const UObject* Outer = OuterChain[Index].Get();
+		if (!ensure(Outer))
+		{
+			return nullptr;
+		}
+
+		if (Outer->IsA<UPackage>())
+		{
+			// Root package
+			ensure(Object == Revision.Package);
+			continue;
+		}
+
+		if (Index == ActorIndex)
+		{
+			// Object did not exist yet if not found, or was in another package
+			Object = Revision.ActorGuidToActor.FindRef(ActorGuid);
+
+			if (!Object)
+			{
+				return nullptr;
+			}
+			continue;
+		}
+
+		if (Index == 0 &&
+			MaterialExpressionGuid.IsValid())
+		{
+			if (const UMaterial* Material = Cast<UMaterial>(Object))
+			{
+				// Object did not exist yet if not found
+				return FPropertyHistoryProcessor::FindMaterialExpression(*Material, MaterialExpressionGuid);
+			}
+		}
+
+		UObject* Child = StaticFindObject(nullptr, Object, *Outer->GetName());
+
+		if (!Child &&
+			Object == Revision.Package &&
+			bFollowAssetRenames)
+		{
+			// Package was renamed, its only asset is renamed along with it
+			Child = PropertyHistoryObjectPath::FindOnlyAsset(*Revision.Package);
+		}
+
+		Object = Child;
+
+		if (!Object)
+		{
+			// Object did not exist yet
+			return nullptr;
+		}
+	}
+
+	// Packages the object moved through can hold something else under the same name, eg a redirector
+	if (!Object->IsA(OuterChain[0]->GetClass()))
+	{
+		return nullptr;
+	}
+
+	return Object;
+}
@@ -0,0 +1,56 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FPropertyHistoryRevision;
+
+// Locates an object in the revisions of its package, through its outer chain
+class FPropertyHistoryObjectPath
+{
+public:
+	bool Initialize(const UObject& Object);
+
+	// Null if the object did not exist in that revision
+	UObject* Resolve(const FPropertyHistoryRevision& Revision) const;
+
+	const FString& GetPackageFilename() const
+	{
+		return PackageFilename;
+	}
+	// Set for external actors: their level package holds their history from before they were externalized
+	const FString& GetLevelPackageFilename() const
+	{
+		return LevelPackageFilename;
+	}
+	// Redirectors left behind when the asset was moved or renamed: their packages hold its history from before
+	const TArray<FString>& GetRedirectorPackageFilenames() const
+	{
+		return RedirectorPackageFilenames;
+	}
+	// Set for the class defaults of a Blueprint: revisions only need to read them, not to load the Blueprint
+	UClass* GetDefaultsClass() const
+	{
+		return DefaultsClass.Get();
+	}
+
+private:
+	// Object first, then its outers up to its package or external package
+	TArray<TWeakObjectPtr<const UObject>> OuterChain;
+	FString PackageFilename;
+	FString LevelPackageFilename;
+	TArray<FString> RedirectorPackageFilenames;
+	TWeakObjectPtr<UClass> DefaultsClass;
+
+	// Set if the object is in the only asset of a package that is not a map:
+	// revisions where that asset is not found by name are assumed to have it under an older name
+	bool bFollowAssetRenames = false;
+
+	// Material expressions are found by guid, their names are not stable
+	FGuid MaterialExpressionGuid;
+
+	// Actors are found by guid, they keep it when renamed, moved to another package or externalized
+	FGuid ActorGuid;
+	int32 ActorIndex = -1;
+};
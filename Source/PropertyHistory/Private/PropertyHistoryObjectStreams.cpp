@@ -0,0 +1,324 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryObjectStreams.h"
+#include "ISourceControlRevision.h"
+#include "Algo/StableSort.h"
+
+FPropertyHistoryObjectStreams::FPropertyHistoryObjectStreams(const FPropertyHistoryObjectPath& ObjectPath)
+	: DefaultsClass(ObjectPath.GetDefaultsClass())
+{
+	AddStream(ObjectPath.GetPackageFilename());
+
+	if (!ObjectPath.GetLevelPackageFilename().IsEmpty())
+	{
+		AddStream(ObjectPath.GetLevelPackageFilename(), {}, true);
+	}
+
+	for (const FString& RedirectorPackageFilename : ObjectPath.GetRedirectorPackageFilenames())
+	{
+		AddStream(RedirectorPackageFilename);
+	}
+}
+
+FPropertyHistoryObjectStreams::~FPropertyHistoryObjectStreams()
+{
+	if (!bSubscribed)
+	{
+		return;
+	}
+
+	for (int32 Index = 0; Index < Streams.Num(); Index++)
+	{
+		UnbindStream(Index);
+	}
+}
+
+void FPropertyHistoryObjectStreams::Subscribe(const EPropertyHistoryPriority NewPriority)
+{
+	if (bSubscribed)
+	{
+		return;
+	}
+	bSubscribed = true;
+	Priority = NewPriority;
+
+	// Streams added by following renames are bound as they are added
+	const int32 NumStreams = Streams.Num();
+	for (int32 Index = 0; Index < NumStreams; Index++)
+	{
+		BindStream(Index);
+	}
+}
+
+void FPropertyHistoryObjectStreams::Unsubscribe()
+{
+	if (!bSubscribed)
+	{
+		return;
+	}
+	bSubscribed = false;
+
+	for (int32 Index = 0; Index < Streams.Num(); Index++)
+	{
+		UnbindStream(Index);
+	}
+
+	OnStateChanged.Broadcast();
+}
+
+void FPropertyHistoryObjectStreams::MakePriority() const
+{
+	FPropertyHistoryPackageStream::SetPriorityStream(Streams[0].Stream);
+}
+
+bool FPropertyHistoryObjectStreams::IsLoading() const
+{
+	if (!bSubscribed)
+	{
+		return false;
+	}
+
+	for (const FStream& Stream : Streams)
+	{
+		if (Stream.Stream->IsLoading())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+TArray<TSharedRef<FPropertyHistoryRevision>> FPropertyHistoryObjectStreams::GetRevisions() const
+{
+	if (Streams.Num() == 1)
+	{
+		return Streams[0].Stream->GetRevisions();
+	}
+
+	// A move is a single check-in touching both packages, only keep the revision of the first stream
+	TSet<int32> CheckInIdentifiers;
+
+	// Level revisions saved once the actor was externalized do not have it anymore
+	// The oldest revision of the main stream is only known once its history is up to date
+	TOptional<FDateTime> MainStreamMinDate;
+	if (const FPropertyHistoryPackageStream& MainStream = *Streams[0].Stream;
+		MainStream.IsUpToDate() &&
+		MainStream.GetRevisions().Num() > 0)
+	{
+		MainStreamMinDate = MainStream.GetRevisions().Last()->Revision->GetDate();
+	}
+
+	TArray<TSharedRef<FPropertyHistoryRevision>> Revisions;
+	for (const FStream& Stream : Streams)
+	{
+		if (Stream.bBeforeMainStream &&
+			!Streams[0].Stream->IsUpToDate())
+		{
+			continue;
+		}
+
+		for (const TSharedRef<FPropertyHistoryRevision>& Revision : Stream.Stream->GetRevisions())
+		{
+			if (Stream.MaxDate.IsSet() &&
+				Revision->Revision->GetDate() > Stream.MaxDate.GetValue())
+			{
+				continue;
+			}
+
+			// The externalizing check-in already saved the level without the actor
+			if (Stream.bBeforeMainStream &&
+				MainStreamMinDate.IsSet() &&
+				Revision->Revision->GetDate() >= MainStreamMinDate.GetValue())
+			{
+				continue;
+			}
+
+			const int32 CheckInIdentifier = Revision->Revision->GetCheckInIdentifier();
+			if (CheckInIdentifier != 0)
+			{
+				bool bAlreadyInSet = false;
+				CheckInIdentifiers.Add(CheckInIdentifier, &bAlreadyInSet);
+
+				if (bAlreadyInSet)
+				{
+					continue;
+				}
+			}
+
+			Revisions.Add(Revision);
+		}
+	}
+
+	// Each stream is already sorted, keep their order for revisions with the same date
+	Algo::StableSort(Revisions, [](const TSharedRef<FPropertyHistoryRevision>& A, const TSharedRef<FPropertyHistoryRevision>& B)
+	{
+		return A->Revision->GetDate() > B->Revision->GetDate();
+	});
+
+	return Revisions;
+}
+
+void FPropertyHistoryObjectStreams::RequestReload(const TSharedRef<FPropertyHistoryRevision>& Revision) const
+{
+	for (const FStream& Stream : Streams)
+	{
+		if (Stream.Stream->GetRevisions().Contains(Revision))
+		{
+			Stream.Stream->RequestReload(Revision);
+			return;
+		}
+	}
+}
+
+TArray<FString> FPropertyHistoryObjectStreams::ConsumeErrors()
+{
+	TArray<FString> Errors;
+	for (FStream& Stream : Streams)
+	{
+		const TArray<FString>& StreamErrors = Stream.Stream->GetErrors();
+		for (; Stream.NumConsumedErrors < StreamErrors.Num(); Stream.NumConsumedErrors++)
+		{
+			Errors.Add(StreamErrors[Stream.NumConsumedErrors]);
+		}
+	}
+	return Errors;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FPropertyHistoryObjectStreams::AddStream(const FString& PackageFilename, const TOptional<FDateTime>& MaxDate, const bool bBeforeMainStream)
+{
+	Streams.Add(FStream
+	{
+		FPropertyHistoryPackageStream::FindOrAdd(PackageFilename, DefaultsClass.Get()),
+		MaxDate,
+		bBeforeMainStream
+	});
+}
+
+void FPropertyHistoryObjectStreams::BindStream(const int32 StreamIndex)
+{
+	FPropertyHistoryPackageStream& Stream = *Streams[StreamIndex].Stream;
+
+	Stream.OnRevisionLoaded.AddSPLambda(this, [this](const FPropertyHistoryRevision&)
+	{
+		OnUpdated.Broadcast();
+	});
+	Stream.OnRevisionsChanged.AddSPLambda(this, [this, StreamIndex]
+	{
+		FollowRename(StreamIndex);
+		OnUpdated.Broadcast();
+	});
+	Stream.OnError.AddSPLambda(this, [this](const FString&)
+	{
+		OnUpdated.Broadcast();
+	});
+	Stream.OnStateChanged.AddSPLambda(this, [this]
+	{
+		OnStateChanged.Broadcast();
+	});
+	Stream.AddSubscriber(Priority);
+
+	// Stream might be shared with another history and already up to date
+	FollowRename(StreamIndex);
+}
+
+void FPropertyHistoryObjectStreams::UnbindStream(const int32 StreamIndex)
+{
+	FPropertyHistoryPackageStream& Stream = *Streams[StreamIndex].Stream;
+
+	Stream.OnRevisionLoaded.RemoveAll(this);
+	Stream.OnRevisionsChanged.RemoveAll(this);
+	Stream.OnError.RemoveAll(this);
+	Stream.OnStateChanged.RemoveAll(this);
+	Stream.RemoveSubscriber(Priority);
+}
+
+void FPropertyHistoryObjectStreams::FollowRename(const int32 StreamIndex)
+{
+	const FPropertyHistoryPackageStream& Stream = *Streams[StreamIndex].Stream;
+
+	// Stored revisions have no branch source, wait for the actual history
+	if (Streams[StreamIndex].bFollowedRename ||
+		!Stream.IsUpToDate())
+	{
+		return;
+	}
+	Streams[StreamIndex].bFollowedRename = true;
+
+	const TArray<TSharedRef<FPropertyHistoryRevision>>& Revisions = Stream.GetRevisions();
+	if (Revisions.Num() == 0)
+	{
+		return;
+	}
+
+	// Only the oldest revision can be a move/add or a branch
+	const TSharedPtr<ISourceControlRevision> BranchSource = Revisions.Last()->Revision->GetBranchSource();
+	if (!BranchSource)
+	{
+		return;
+	}
+
+	// Providers following renames themselves, eg git with --follow, already list the revisions under the old name
+	for (const TSharedRef<FPropertyHistoryRevision>& Revision : Revisions)
+	{
+		if (Revision->Revision->GetFilename() == BranchSource->GetFilename())
+		{
+			return;
+		}
+	}
+
+	const FString PackageFilename = GetLocalFilename(Stream, BranchSource->GetFilename());
+	if (PackageFilename.IsEmpty())
+	{
+		return;
+	}
+
+	for (const FStream& OtherStream : Streams)
+	{
+		if (FPaths::IsSamePath(OtherStream.Stream->GetPackageFilename(), PackageFilename))
+		{
+			return;
+		}
+	}
+
+	AddStream(PackageFilename, BranchSource->GetDate());
+
+	if (bSubscribed)
+	{
+		BindStream(Streams.Num() - 1);
+	}
+
+	OnStateChanged.Broadcast();
+}
+
+FString FPropertyHistoryObjectStreams::GetLocalFilename(const FPropertyHistoryPackageStream& Stream, const FString& SourceControlFilename)
+{
+	if (Stream.GetRevisions().Num() == 0)
+	{
+		return {};
+	}
+
+	const FString LocalFilename = FPaths::ConvertRelativePathToFull(Stream.GetPackageFilename());
+	const FString& StreamFilename = Stream.GetRevisions()[0]->Revision->GetFilename();
+
+	// Both point to the same file: the part they have in common is relative to their roots
+	int32 SuffixLength = 0;
+	while (
+		SuffixLength < LocalFilename.Len() &&
+		SuffixLength < StreamFilename.Len() &&
+		FChar::ToLower(LocalFilename[LocalFilename.Len() - 1 - SuffixLength]) == FChar::ToLower(StreamFilename[StreamFilename.Len() - 1 - SuffixLength]))
+	{
+		SuffixLength++;
+	}
+
+	const FString SourceControlRoot = StreamFilename.LeftChop(SuffixLength);
+	if (!SourceControlFilename.StartsWith(SourceControlRoot))
+	{
+		return {};
+	}
+
+	return LocalFilename.LeftChop(SuffixLength) + SourceControlFilename.RightChop(SourceControlRoot.Len());
+}
@@ -0,0 +1,68 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PropertyHistoryObjectPath.h"
+#include "PropertyHistoryPackageStream.h"
+
+// All the package streams the history of an object is spread over:
+// its own package, the level an external actor was embedded in before being externalized,
+// and the packages the asset was moved or renamed from
+class FPropertyHistoryObjectStreams : public TSharedFromThis<FPropertyHistoryObjectStreams>
+{
+public:
+	// A revision was loaded, revisions changed or an error happened
+	FSimpleMulticastDelegate OnUpdated;
+	FSimpleMulticastDelegate OnStateChanged;
+
+public:
+	explicit FPropertyHistoryObjectStreams(const FPropertyHistoryObjectPath& ObjectPath);
+	~FPropertyHistoryObjectStreams();
+
+	// Streams are scheduled at the priority of their most important subscriber
+	void Subscribe(EPropertyHistoryPriority NewPriority = EPropertyHistoryPriority::Background);
+	// Streams stop once nobody is subscribed to them anymore
+	void Unsubscribe();
+
+	bool IsSubscribed() const
+	{
+		return bSubscribed;
+	}
+
+	// Only the main package is made priority, other streams only go back further in time
+	void MakePriority() const;
+	bool IsLoading() const;
+
+	// Newest first, across all streams
+	TArray<TSharedRef<FPropertyHistoryRevision>> GetRevisions() const;
+	// Loads a revision that was unloaded again, see FPropertyHistoryPackageStream::RequestReload
+	void RequestReload(const TSharedRef<FPropertyHistoryRevision>& Revision) const;
+	// Errors that were not returned by a previous call
+	TArray<FString> ConsumeErrors();
+
+private:
+	struct FStream
+	{
+		TSharedRef<FPropertyHistoryPackageStream> Stream;
+		// Set for packages the object was moved from: their later revisions are not about it anymore
+		TOptional<FDateTime> MaxDate;
+		// Set for the level of an external actor: only its revisions older than the external package are about the actor
+		bool bBeforeMainStream = false;
+		int32 NumConsumedErrors = 0;
+		bool bFollowedRename = false;
+	};
+	TArray<FStream> Streams;
+	TWeakObjectPtr<UClass> DefaultsClass;
+	bool bSubscribed = false;
+	EPropertyHistoryPriority Priority = EPropertyHistoryPriority::Background;
+
+	void AddStream(const FString& PackageFilename, const TOptional<FDateTime>& MaxDate = {}, bool bBeforeMainStream = false);
+	void BindStream(int32 StreamIndex);
+	void UnbindStream(int32 StreamIndex);
+
+	// Follows moves recorded by source control, eg Perforce move/add and branch records
+	void FollowRename(int32 StreamIndex);
+	// Source control filenames are eg depot paths, map them to local ones through the filenames of a stream
+	static FString GetLocalFilename(const FPropertyHistoryPackageStream& Stream, const FString& SourceControlFilename);
+};
@@ -0,0 +1,819 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryPackageStream.h"
+#include "Async/Async.h"
+#include "ISourceControlModule.h"
+#include "SourceControlOperations.h"
+#include "PropertyHistoryUtilities.h"
+#include "PropertyHistoryRevisionData.h"
+#include "PropertyHistoryRevisionStore.h"
+#include "PropertyHistoryReplay.h"
+#include "PropertyHistorySharedCache.h"
+#include "PropertyHistoryGitLfs.h"
+#include "GameFramework/Actor.h"
+
+static TAutoConsoleVariable<int32> CVarPropertyHistoryMaxLoadedRevisions(
+	TEXT("PropertyHistory.MaxLoadedRevisions"),
+	16,
+	TEXT("Max number of revisions whose package is kept loaded, per package. Older ones are reloaded from the revision cache if needed again"));
+
+namespace PropertyHistoryPackageStream
+{
+	TMap<FString, TWeakPtr<FPropertyHistoryPackageStream>> Streams;
+	TWeakPtr<FPropertyHistoryPackageStream> PriorityStream;
+}
+
+TSharedRef<FPropertyHistoryPackageStream> FPropertyHistoryPackageStream::FindOrAdd(const FString& PackageFilename, UClass* DefaultsClass)
+{
+	using namespace PropertyHistoryPackageStream;
+
+	for (auto It = Streams.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	// Class defaults streams load something else from the same revisions
+	const FString Key = DefaultsClass ? PackageFilename + ":" + DefaultsClass->GetPathName() : PackageFilename;
+
+	if (const TSharedPtr<FPropertyHistoryPackageStream> Stream = Streams.FindRef(Key).Pin())
+	{
+		return Stream.ToSharedRef();
+	}
+
+	const TSharedRef<FPropertyHistoryPackageStream> Stream = MakeShared<FPropertyHistoryPackageStream>(PackageFilename, DefaultsClass);
+	Streams.Add(Key, Stream);
+	return Stream;
+}
+
+void FPropertyHistoryPackageStream::SetPriorityStream(const TSharedPtr<FPropertyHistoryPackageStream>& Stream)
+{
+	check(IsInGameThread());
+
+	// Queued work reads its priority when the scheduler picks it, nothing to reorder
+	PropertyHistoryPackageStream::PriorityStream = Stream;
+}
+
+FPropertyHistoryPackageStream::FPropertyHistoryPackageStream(const FString& PackageFilename, UClass* DefaultsClass)
+	: PackageFilename(PackageFilename)
+	, DefaultsClass(DefaultsClass)
+{
+}
+
+FPropertyHistoryPackageStream::~FPropertyHistoryPackageStream()
+{
+	// Drops everything still queued in the scheduler
+	*CancellationToken = true;
+}
+
+void FPropertyHistoryPackageStream::AddSubscriber(const EPropertyHistoryPriority Priority)
+{
+	NumSubscribers[int32(Priority)]++;
+	Start();
+}
+
+void FPropertyHistoryPackageStream::RemoveSubscriber(const EPropertyHistoryPriority Priority)
+{
+	if (!ensure(NumSubscribers[int32(Priority)] > 0))
+	{
+		return;
+	}
+
+	NumSubscribers[int32(Priority)]--;
+
+	if (GetNumSubscribers() == 0)
+	{
+		Cancel();
+	}
+}
+
+bool FPropertyHistoryPackageStream::IsLoading() const
+{
+	if (!bStarted ||
+		bFailed ||
+		IsCancelled())
+	{
+		return false;
+	}
+
+	if (!bUpToDate)
+	{
+		return true;
+	}
+
+	for (const TSharedRef<FPropertyHistoryRevision>& Revision : Revisions)
+	{
+		if (!Revision->bLoaded ||
+			Revision->bReloadRequested)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void FPropertyHistoryPackageStream::RequestReload(const TSharedRef<FPropertyHistoryRevision>& Revision)
+{
+	check(IsInGameThread());
+
+	if (!Revision->bLoaded ||
+		Revision->bLoadFailed ||
+		Revision->Package ||
+		Revision->bReloadRequested ||
+		!ensure(Revisions.Contains(Revision)))
+	{
+		return;
+	}
+	Revision->bReloadRequested = true;
+
+	if (bStarted &&
+		!IsCancelled() &&
+		!FetchingRevision &&
+		!bFetched)
+	{
+		FetchNext();
+	}
+	OnStateChanged.Broadcast();
+}
+
+EPropertyHistoryPriority FPropertyHistoryPackageStream::GetPriority() const
+{
+	if (PropertyHistoryPackageStream::PriorityStream.Pin().Get() == this)
+	{
+		return EPropertyHistoryPriority::Visible;
+	}
+
+	for (int32 Index = 0; Index < int32(EPropertyHistoryPriority::Num); Index++)
+	{
+		if (NumSubscribers[Index] > 0)
+		{
+			return EPropertyHistoryPriority(Index);
+		}
+	}
+
+	return EPropertyHistoryPriority::Indexing;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FPropertyHistoryPackageStream::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	for (const TSharedRef<FPropertyHistoryRevision>& Revision : Revisions)
+	{
+		Collector.AddReferencedObject(Revision->Package);
+		Collector.AddReferencedObjects(Revision->Objects);
+	}
+}
+
+FString FPropertyHistoryPackageStream::GetReferencerName() const
+{
+	return "FPropertyHistoryPackageStream " + PackageFilename;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FPropertyHistoryPackageStream::Start()
+{
+	check(IsInGameThread());
+
+	if (bStarted &&
+		!IsCancelled())
+	{
+		return;
+	}
+
+	// Replays only depend on the recording, not on what real histories stored
+	if (!bStarted &&
+		FPropertyHistoryReplaySettings::Get().Mode != EPropertyHistoryReplayMode::Replay)
+	{
+		// Show what we already know while source control is queried
+		const bool bHasCache =
+			!FPropertyHistoryRevisionData::GetCacheDirectory().IsEmpty() ||
+			!FPropertyHistorySharedCache::GetDirectory().IsEmpty();
+		for (const TSharedRef<FPropertyHistoryStoredRevision>& StoredRevision : FPropertyHistoryRevisionStore::Load(PackageFilename))
+		{
+			const TSharedRef<FPropertyHistoryRevision> Revision = MakeRevision(StoredRevision);
+			Revision->bStored = true;
+			Revision->bNeedsProvider = !bHasCache;
+			Revisions.Add(Revision);
+		}
+	}
+
+	// Either first start or resume after a cancel: revisions that are already loaded are kept
+	bStarted = true;
+	bFailed = false;
+	CancellationToken = MakeShared<FThreadSafeBool>(false);
+
+	if (Revisions.Num() > 0)
+	{
+		OnRevisionsChanged.Broadcast();
+	}
+
+	Resume();
+	OnStateChanged.Broadcast();
+}
+
+void FPropertyHistoryPackageStream::Cancel()
+{
+	check(IsInGameThread());
+
+	*CancellationToken = true;
+
+	if (UpdateStatusOperation)
+	{
+		ISourceControlProvider& SourceControlProvider = ISourceControlModule::Get().GetProvider();
+		if (SourceControlProvider.CanCancelOperation(UpdateStatusOperation.ToSharedRef()))
+		{
+			SourceControlProvider.CancelOperation(UpdateStatusOperation.ToSharedRef());
+		}
+		UpdateStatusOperation.Reset();
+	}
+	bQuerying = false;
+	PrefetchingRevisions.Reset();
+	bWaitingForPrefetch = false;
+
+	FetchingRevision.Reset();
+	bFetched = false;
+	FetchedData.Reset();
+	bLoadRequested = false;
+
+	if (PropertyHistoryPackageStream::PriorityStream == AsWeak())
+	{
+		SetPriorityStream(nullptr);
+	}
+
+	OnStateChanged.Broadcast();
+}
+
+int32 FPropertyHistoryPackageStream::GetNumSubscribers() const
+{
+	int32 Num = 0;
+	for (const int32 NumWithPriority : NumSubscribers)
+	{
+		Num += NumWithPriority;
+	}
+	return Num;
+}
+
+TFunction<EPropertyHistoryPriority()> FPropertyHistoryPackageStream::MakeGetPriority() const
+{
+	return MakeWeakPtrLambda(this, [this]
+	{
+		return GetPriority();
+	}, EPropertyHistoryPriority::Indexing);
+}
+
+TSharedRef<FPropertyHistoryRevision> FPropertyHistoryPackageStream::MakeRevision(const TSharedRef<ISourceControlRevision>& SourceControlRevision) const
+{
+	static int32 NextId = 0;
+
+	const TSharedRef<FPropertyHistoryRevision> Revision = MakeShared<FPropertyHistoryRevision>();
+	Revision->Id = NextId++;
+	Revision->Revision = SourceControlRevision;
+	Revision->PackageFilename = PackageFilename;
+	return Revision;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Resumes the stream where it left off, whatever step that was
+void FPropertyHistoryPackageStream::Resume()
+{
+	if (IsCancelled() ||
+		bFailed)
+	{
+		return;
+	}
+
+	if (!bUpToDate &&
+		!bQuerying)
+	{
+		bQuerying = true;
+
+		FPropertyHistoryScheduler::Get().Request(
+			EPropertyHistoryStage::Query,
+			MakeGetPriority(),
+			CancellationToken,
+			MakeWeakPtrLambda(this, [this](const FPropertyHistoryTask& Task)
+			{
+				UpdateStatus(Task);
+			}));
+	}
+
+	if (bFetched)
+	{
+		RequestLoad();
+	}
+	else if (!FetchingRevision)
+	{
+		FetchNext();
+	}
+}
+
+void FPropertyHistoryPackageStream::UpdateStatus(const FPropertyHistoryTask& Task)
+{
+	const FPropertyHistoryReplaySettings ReplaySettings = FPropertyHistoryReplaySettings::Get();
+	if (ReplaySettings.Mode == EPropertyHistoryReplayMode::Replay)
+	{
+		FPropertyHistoryReplay::ReplayHistory(ReplaySettings, PackageFilename, [Task, Token = CancellationToken, WeakThis = AsWeak()](const TOptional<TArray<TSharedRef<ISourceControlRevision>>>& Revisions)
+		{
+			FPropertyHistoryScheduler::Get().Finish(Task);
+
+			const TSharedPtr<FPropertyHistoryPackageStream> This = WeakThis.Pin();
+			if (!This ||
+				*Token)
+			{
+				return;
+			}
+			This->bQuerying = false;
+
+			if (!Revisions.IsSet())
+			{
+				This->Fail("No recorded history for " + This->PackageFilename);
+				return;
+			}
+
+			This->OnHistory(Revisions.GetValue());
+		});
+		return;
+	}
+
+	ISourceControlProvider& SourceControlProvider = ISourceControlModule::Get().GetProvider();
+
+	UpdateStatusOperation = ISourceControlOperation::Create<FUpdateStatus>();
+	UpdateStatusOperation->SetUpdateHistory(true);
+
+	// Some providers complete synchronously when they fail to start
+	const TSharedRef<bool> bCompleted = MakeShared<bool>(false);
+
+	const auto OnCompleted = MakeWeakPtrLambda(this, [this, Token = CancellationToken](const FSourceControlOperationRef&, const ECommandResult::Type Result)
+	{
+		check(IsInGameThread());
+
+		if (*Token)
+		{
+			return;
+		}
+		bQuerying = false;
+		UpdateStatusOperation.Reset();
+
+		if (Result != ECommandResult::Succeeded)
+		{
+			Fail("Failed to update status for " + PackageFilename);
+			return;
+		}
+
+		ISourceControlProvider& SourceControlProvider = ISourceControlModule::Get().GetProvider();
+
+		TArray<FSourceControlStateRef> SourceControlStates;
+		if (SourceControlProvider.GetState(
+			{ PackageFilename },
+			SourceControlStates,
+			EStateCacheUsage::Use) != ECommandResult::Succeeded)
+		{
+			SourceControlStates.Empty();
+		}
+
+		if (SourceControlStates.Num() != 1)
+		{
+			Fail("Failed to get source control state for " + PackageFilename);
+			return;
+		}
+
+		OnUpdateStatus(SourceControlStates[0]);
+	});
+
+	if (!SourceControlProvider.Execute(
+		UpdateStatusOperation.ToSharedRef(),
+		{ PackageFilename },
+		EConcurrency::Asynchronous,
+		MakeLambdaDelegate([Task, bCompleted, OnCompleted](const FSourceControlOperationRef& Operation, const ECommandResult::Type Result)
+		{
+			// Always give the slot back, even if the stream is gone
+			*bCompleted = true;
+			FPropertyHistoryScheduler::Get().Finish(Task);
+
+			OnCompleted(Operation, Result);
+		})))
+	{
+		if (*bCompleted)
+		{
+			return;
+		}
+
+		FPropertyHistoryScheduler::Get().Finish(Task);
+		bQuerying = false;
+		UpdateStatusOperation.Reset();
+		Fail("Failed to update status for " + PackageFilename);
+	}
+}
+
+void FPropertyHistoryPackageStream::OnUpdateStatus(const TSharedRef<ISourceControlState>& State)
+{
+	TArray<TSharedRef<ISourceControlRevision>> SourceControlRevisions;
+	for (int32 HistoryIndex = 0; HistoryIndex < State->GetHistorySize(); HistoryIndex++)
+	{
+		const TSharedPtr<ISourceControlRevision> SourceControlRevision = State->GetHistoryItem(HistoryIndex);
+		if (!SourceControlRevision)
+		{
+			AddError("Failed to get source control state for " + PackageFilename);
+			continue;
+		}
+
+		SourceControlRevisions.Add(SourceControlRevision.ToSharedRef());
+	}
+
+	const FPropertyHistoryReplaySettings ReplaySettings = FPropertyHistoryReplaySettings::Get();
+	if (ReplaySettings.Mode == EPropertyHistoryReplayMode::Record)
+	{
+		FPropertyHistoryReplay::RecordHistory(ReplaySettings, PackageFilename, SourceControlRevisions);
+	}
+
+	OnHistory(SourceControlRevisions);
+}
+
+void FPropertyHistoryPackageStream::OnHistory(const TArray<TSharedRef<ISourceControlRevision>>& SourceControlRevisions)
+{
+	// Source control APIs have no way to only query revisions newer than the ones we stored:
+	// reuse every revision we already know, loaded or not, and only add the missing ones
+	TMap<FString, TSharedRef<FPropertyHistoryRevision>> KnownRevisions;
+	for (const TSharedRef<FPropertyHistoryRevision>& Revision : Revisions)
+	{
+		KnownRevisions.Add(Revision->Revision->GetRevision(), Revision);
+	}
+
+	TArray<TSharedRef<FPropertyHistoryRevision>> NewRevisions;
+	for (const TSharedRef<ISourceControlRevision>& SourceControlRevision : SourceControlRevisions)
+	{
+		if (const TSharedRef<FPropertyHistoryRevision>* KnownRevision = KnownRevisions.Find(SourceControlRevision->GetRevision()))
+		{
+			(*KnownRevision)->Revision = SourceControlRevision;
+			(*KnownRevision)->bStored = false;
+			(*KnownRevision)->bNeedsProvider = false;
+			NewRevisions.Add(*KnownRevision);
+			continue;
+		}
+
+		NewRevisions.Add(MakeRevision(SourceControlRevision));
+	}
+
+	Revisions = MoveTemp(NewRevisions);
+	bUpToDate = true;
+
+	if (FPropertyHistoryReplaySettings::Get().Mode != EPropertyHistoryReplayMode::Replay)
+	{
+		FPropertyHistoryRevisionStore::Save(PackageFilename, SourceControlRevisions);
+	}
+
+	OnRevisionsChanged.Broadcast();
+	OnStateChanged.Broadcast();
+
+	Prefetch();
+
+	if (!FetchingRevision &&
+		!bFetched)
+	{
+		FetchNext();
+	}
+}
+
+void FPropertyHistoryPackageStream::Prefetch()
+{
+	check(IsInGameThread());
+
+	const FPropertyHistoryGitLfs GitLfs = FPropertyHistoryGitLfs::Get();
+	if (!GitLfs.IsEnabled() ||
+		FPropertyHistoryReplaySettings::Get().Mode == EPropertyHistoryReplayMode::Replay)
+	{
+		return;
+	}
+
+	const FString CacheDirectory = FPropertyHistoryRevisionData::GetCacheDirectory();
+
+	TArray<FString> RevisionsToPrefetch;
+	for (const TSharedRef<FPropertyHistoryRevision>& Revision : Revisions)
+	{
+		// Don't download what is already cached
+		if (!Revision->bLoaded &&
+			!PrefetchingRevisions.Contains(Revision->Revision->GetRevision()) &&
+			(CacheDirectory.IsEmpty() || !IFileManager::Get().FileExists(*(CacheDirectory / FPropertyHistoryRevisionData::GetCacheKey(PackageFilename, *Revision->Revision) + FPaths::GetExtension(PackageFilename, true)))))
+		{
+			RevisionsToPrefetch.Add(Revision->Revision->GetRevision());
+		}
+	}
+
+	// Newest first like fetches: the first batch holds the revisions fetched first, and batches download while earlier ones are loaded
+	for (TArray<FString>& Batch : FPropertyHistoryGitLfs::MakePrefetchBatches(RevisionsToPrefetch))
+	{
+		PrefetchingRevisions.Append(Batch);
+
+		FPropertyHistoryScheduler::Get().Request(
+			EPropertyHistoryStage::Fetch,
+			MakeGetPriority(),
+			CancellationToken,
+			MakeWeakPtrLambda(this, [this, GitLfs, Batch = MoveTemp(Batch)](const FPropertyHistoryTask& Task)
+			{
+				Async(EAsyncExecution::LargeThreadPool, [Task, GitLfs, PackageFilename = PackageFilename, Batch, Token = CancellationToken, WeakThis = AsWeak()]
+				{
+					if (!*Token)
+					{
+						GitLfs.Prefetch(PackageFilename, Batch);
+					}
+
+					AsyncTask(ENamedThreads::GameThread, [Task, Batch, Token, WeakThis]
+					{
+						FPropertyHistoryScheduler::Get().Finish(Task);
+
+						const TSharedPtr<FPropertyHistoryPackageStream> This = WeakThis.Pin();
+						if (!This ||
+							*Token)
+						{
+							return;
+						}
+
+						for (const FString& Revision : Batch)
+						{
+							This->PrefetchingRevisions.Remove(Revision);
+						}
+
+						if (This->bWaitingForPrefetch)
+						{
+							This->bWaitingForPrefetch = false;
+							This->FetchNext();
+						}
+					});
+				});
+			}));
+	}
+}
+
+TSharedPtr<FPropertyHistoryRevision> FPropertyHistoryPackageStream::FindNextRevisionToLoad() const
+{
+	for (const TSharedRef<FPropertyHistoryRevision>& Revision : Revisions)
+	{
+		if (Revision->bReloadRequested)
+		{
+			return Revision;
+		}
+
+		if (Revision->bLoaded ||
+			Revision->bNeedsProvider)
+		{
+			continue;
+		}
+
+		return Revision;
+	}
+
+	return nullptr;
+}
+
+void FPropertyHistoryPackageStream::FetchNext()
+{
+	check(IsInGameThread());
+	check(!FetchingRevision);
+	check(!bFetched);
+
+	if (IsCancelled() ||
+		bWaitingForPrefetch)
+	{
+		return;
+	}
+
+	const TSharedPtr<FPropertyHistoryRevision> Revision = FindNextRevisionToLoad();
+	if (!Revision)
+	{
+		if (bUpToDate)
+		{
+			Finish();
+		}
+		// Otherwise wait for source control
+		return;
+	}
+
+	FetchingRevision = Revision;
+
+	FPropertyHistoryScheduler::Get().Request(
+		EPropertyHistoryStage::Fetch,
+		MakeGetPriority(),
+		CancellationToken,
+		MakeWeakPtrLambda(this, [this, Revision](const FPropertyHistoryTask& Task)
+		{
+			const bool bPrefetching = PrefetchingRevisions.Contains(Revision->Revision->GetRevision());
+
+			Async(EAsyncExecution::LargeThreadPool, [Task, SourceControlRevision = Revision->Revision.ToSharedRef(), bPrefetching, PackageFilename = PackageFilename, CacheDirectory = FPropertyHistoryRevisionData::GetCacheDirectory(), SharedCacheDirectory = FPropertyHistorySharedCache::GetDirectory(), GitLfs = FPropertyHistoryGitLfs::Get(), ReplaySettings = FPropertyHistoryReplaySettings::Get(), Token = CancellationToken, WeakThis = AsWeak()]
+			{
+				TSharedPtr<FPropertyHistoryRevisionData> Data;
+				bool bWaitForPrefetch = false;
+				if (!*Token)
+				{
+					// Objects already in the local store don't need to wait for their batch
+					bWaitForPrefetch =
+						bPrefetching &&
+						GitLfs.FindObjectPath(PackageFilename, SourceControlRevision->GetRevision()).IsEmpty();
+
+					if (!bWaitForPrefetch)
+					{
+						Data = FPropertyHistoryRevisionData::Fetch(PackageFilename, *SourceControlRevision, CacheDirectory, SharedCacheDirectory, GitLfs, ReplaySettings);
+					}
+				}
+
+				AsyncTask(ENamedThreads::GameThread, [Task, Data = MoveTemp(Data), bWaitForPrefetch, Revision = SourceControlRevision->GetRevision(), Token, WeakThis]
+				{
+					// Cancelled fetches still give their slot back
+					FPropertyHistoryScheduler::Get().Finish(Task, Data ? Data->GetView().Num() : 0);
+
+					const TSharedPtr<FPropertyHistoryPackageStream> This = WeakThis.Pin();
+					if (!This ||
+						*Token)
+					{
+						return;
+					}
+
+					if (bWaitForPrefetch)
+					{
+						This->FetchingRevision.Reset();
+
+						// The batch might have finished while we were checking
+						if (This->PrefetchingRevisions.Contains(Revision))
+						{
+							This->bWaitingForPrefetch = true;
+						}
+						else
+						{
+							This->FetchNext();
+						}
+						return;
+					}
+
+					This->bFetched = true;
+					This->FetchedData = Data;
+					This->RequestLoad();
+				});
+			});
+		}));
+}
+
+void FPropertyHistoryPackageStream::RequestLoad()
+{
+	check(IsInGameThread());
+	check(bFetched);
+
+	if (bLoadRequested)
+	{
+		return;
+	}
+	bLoadRequested = true;
+
+	// Don't load from within the task graph, the scheduler time slices loads on the game thread
+	FPropertyHistoryScheduler::Get().Request(
+		EPropertyHistoryStage::Load,
+		MakeGetPriority(),
+		CancellationToken,
+		MakeWeakPtrLambda(this, [this](const FPropertyHistoryTask& Task)
+		{
+			bLoadRequested = false;
+			Load();
+			FPropertyHistoryScheduler::Get().Finish(Task);
+		}));
+}
+
+void FPropertyHistoryPackageStream::Load()
+{
+	check(IsInGameThread());
+
+	if (IsCancelled() ||
+		!ensure(bFetched) ||
+		!ensure(FetchingRevision))
+	{
+		return;
+	}
+
+	const TSharedRef<FPropertyHistoryRevision> Revision = FetchingRevision.ToSharedRef();
+	const TSharedPtr<FPropertyHistoryRevisionData> Data = FetchedData;
+	FetchingRevision.Reset();
+	bFetched = false;
+	FetchedData.Reset();
+
+	if (!Revisions.Contains(Revision))
+	{
+		// Not part of the source control history anymore
+		FetchNext();
+		return;
+	}
+
+	if (!Data)
+	{
+		if (Revision->bStored &&
+			!bUpToDate)
+		{
+			// Stored revision that isn't in any revision cache, retry once source control answers
+			Revision->bNeedsProvider = true;
+			FetchNext();
+			return;
+		}
+
+		Revision->bLoaded = true;
+		Revision->bLoadFailed = true;
+		Revision->bReloadRequested = false;
+		AddError("Failed to fetch revision " + Revision->Revision->GetRevision() + " of " + PackageFilename);
+		OnRevisionLoaded.Broadcast(*Revision);
+		FetchNext();
+		return;
+	}
+
+	Revision->bLoaded = true;
+	Revision->bReloadRequested = false;
+	Revision->ContentHash = Data->ContentHash;
+
+	if (DefaultsClass.IsExplicitlyNull())
+	{
+		Revision->Package = Data->LoadPackage(PackageFilename, *Revision->Revision);
+	}
+	else if (UClass* Class = DefaultsClass.Get())
+	{
+		// Loading a Blueprint package loads its parent classes & dependencies, and can be very slow
+		Revision->Package = Data->LoadClassDefaults(PackageFilename, *Revision->Revision, *Class);
+	}
+
+	if (!Revision->Package)
+	{
+		Revision->bLoadFailed = true;
+		AddError("Failed to load package for " + PackageFilename);
+	}
+	else
+	{
+		ForEachObjectWithPackage(Revision->Package, [&](UObject* Object)
+		{
+			Revision->Objects.Add(Object);
+
+			if (AActor* Actor = Cast<AActor>(Object))
+			{
+				Revision->ActorGuidToActor.Add(Actor->GetActorGuid(), Actor);
+			}
+			return true;
+		});
+
+		LoadedRevisions.Add(Revision);
+	}
+
+	// Subscribers extract what they need from the objects while handling this
+	OnRevisionLoaded.Broadcast(*Revision);
+
+	UnloadOldRevisions();
+
+	FetchNext();
+}
+
+void FPropertyHistoryPackageStream::UnloadOldRevisions()
+{
+	const int32 MaxLoadedRevisions = FMath::Max(1, CVarPropertyHistoryMaxLoadedRevisions.GetValueOnGameThread());
+
+	LoadedRevisions.RemoveAll([](const TWeakPtr<FPropertyHistoryRevision>& WeakRevision)
+	{
+		return !WeakRevision.IsValid();
+	});
+
+	while (LoadedRevisions.Num() > MaxLoadedRevisions)
+	{
+		if (const TSharedPtr<FPropertyHistoryRevision> Revision = LoadedRevisions[0].Pin())
+		{
+			// Objects are collected by the next GC, nothing references them but us
+			Revision->Package = nullptr;
+			Revision->Objects.Reset();
+			Revision->ActorGuidToActor.Reset();
+		}
+		LoadedRevisions.RemoveAt(0);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FPropertyHistoryPackageStream::AddError(const FString& NewError)
+{
+	Errors.Add(NewError);
+	OnError.Broadcast(NewError);
+}
+
+void FPropertyHistoryPackageStream::Fail(const FString& NewError)
+{
+	bFailed = true;
+	AddError(NewError);
+	Finish();
+}
+
+void FPropertyHistoryPackageStream::Finish()
+{
+	OnStateChanged.Broadcast();
+}
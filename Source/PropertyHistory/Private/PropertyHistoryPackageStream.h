@@ -0,0 +1,167 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/GCObject.h"
+#include "PropertyHistoryScheduler.h"
+
+class FUpdateStatus;
+class ISourceControlState;
+class ISourceControlRevision;
+class FPropertyHistoryRevisionData;
+class AActor;
+
+struct FPropertyHistoryRevision
+{
+	// Unique for the lifetime of the editor, stable when revisions are inserted before this one
+	int32 Id = 0;
+
+	TSharedPtr<ISourceControlRevision> Revision;
+	// Package of the stream this revision is of
+	FString PackageFilename;
+	// Hash of the revision bytes in the shared cache, set once fetched or shared. Empty if not shared
+	FString ContentHash;
+
+	// Set once a load was attempted, even if it failed
+	bool bLoaded = false;
+	// Set if the revision failed to fetch or load, the error is reported by the stream
+	bool bLoadFailed = false;
+	// Unloaded revision that a subscriber needs the objects of again
+	bool bReloadRequested = false;
+	// Restored from the revision store, not yet confirmed by source control
+	bool bStored = false;
+	// Stored revision that is not in the revision cache: needs the provider revision to be fetched
+	bool bNeedsProvider = false;
+
+	// Null if the package failed to load, or was unloaded once the stream had too many revisions loaded
+	// Subscribers extract what they need when a revision is loaded, and request a reload if they need it again later
+	TObjectPtr<UPackage> Package;
+	// Packages loaded for diff are not rooted, keep all their objects alive while the revision is loaded
+	TArray<TObjectPtr<UObject>> Objects;
+	// Built on load, so that actors are found in O(1) no matter which package they were in
+	TMap<FGuid, TObjectPtr<AActor>> ActorGuidToActor;
+};
+
+// Fetches & loads every revision of a package once, no matter how many handlers are looking at it
+// Every step goes through the scheduler, at the priority of its most important subscriber
+class FPropertyHistoryPackageStream
+	: public TSharedFromThis<FPropertyHistoryPackageStream>
+	, public FGCObject
+{
+public:
+	TMulticastDelegate<void(const FPropertyHistoryRevision&)> OnRevisionLoaded;
+	// Revisions were inserted or removed, eg once the stored history is reconciled with source control
+	FSimpleMulticastDelegate OnRevisionsChanged;
+	TMulticastDelegate<void(const FString&)> OnError;
+	FSimpleMulticastDelegate OnStateChanged;
+
+public:
+	// If DefaultsClass is set, only the class defaults of that Blueprint are read from each revision
+	static TSharedRef<FPropertyHistoryPackageStream> FindOrAdd(const FString& PackageFilename, UClass* DefaultsClass = nullptr);
+
+	// The priority stream is the one shown in a tab, its work is scheduled before any other
+	static void SetPriorityStream(const TSharedPtr<FPropertyHistoryPackageStream>& Stream);
+
+	FPropertyHistoryPackageStream(const FString& PackageFilename, UClass* DefaultsClass);
+	virtual ~FPropertyHistoryPackageStream() override;
+
+	void AddSubscriber(EPropertyHistoryPriority Priority);
+	// Cancels the stream once nobody is subscribed anymore
+	void RemoveSubscriber(EPropertyHistoryPriority Priority);
+
+	bool IsLoading() const;
+	EPropertyHistoryPriority GetPriority() const;
+
+	// Loads an unloaded revision again, from the revision cache if it is still in it
+	// OnRevisionLoaded is broadcast again once loaded
+	void RequestReload(const TSharedRef<FPropertyHistoryRevision>& Revision);
+
+	// True once revisions match the source control history
+	bool IsUpToDate() const
+	{
+		return bUpToDate;
+	}
+
+	const FString& GetPackageFilename() const
+	{
+		return PackageFilename;
+	}
+	// Newest revision first
+	const TArray<TSharedRef<FPropertyHistoryRevision>>& GetRevisions() const
+	{
+		return Revisions;
+	}
+	const TArray<FString>& GetErrors() const
+	{
+		return Errors;
+	}
+
+public:
+	//~ Begin FGCObject Interface
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	virtual FString GetReferencerName() const override;
+	//~ End FGCObject Interface
+
+private:
+	const FString PackageFilename;
+	const TWeakObjectPtr<UClass> DefaultsClass;
+
+	int32 NumSubscribers[int32(EPropertyHistoryPriority::Num)] = {};
+	bool bStarted = false;
+	bool bFailed = false;
+
+	// Replaced on every resume, so that work launched before a cancel is ignored
+	TSharedRef<FThreadSafeBool> CancellationToken = MakeShared<FThreadSafeBool>(false);
+
+	// Set from the query request until its result
+	bool bQuerying = false;
+	TSharedPtr<FUpdateStatus> UpdateStatusOperation;
+	// True once Revisions matches the source control history
+	bool bUpToDate = false;
+
+	// Revisions whose Git LFS object is being downloaded by a prefetch batch
+	TSet<FString> PrefetchingRevisions;
+	// Set if the next revision to fetch is in a batch that is still downloading, instead of fetching it a second time through the provider
+	bool bWaitingForPrefetch = false;
+
+	TSharedPtr<FPropertyHistoryRevision> FetchingRevision;
+	bool bFetched = false;
+	TSharedPtr<FPropertyHistoryRevisionData> FetchedData;
+	bool bLoadRequested = false;
+
+	TArray<TSharedRef<FPropertyHistoryRevision>> Revisions;
+	TArray<FString> Errors;
+
+	// Revisions whose package is loaded, oldest load first
+	TArray<TWeakPtr<FPropertyHistoryRevision>> LoadedRevisions;
+
+	void Start();
+	void Cancel();
+
+	bool IsCancelled() const
+	{
+		return *CancellationToken;
+	}
+	int32 GetNumSubscribers() const;
+	TFunction<EPropertyHistoryPriority()> MakeGetPriority() const;
+
+	TSharedRef<FPropertyHistoryRevision> MakeRevision(const TSharedRef<ISourceControlRevision>& SourceControlRevision) const;
+
+	void Resume();
+	void UpdateStatus(const FPropertyHistoryTask& Task);
+	void OnUpdateStatus(const TSharedRef<ISourceControlState>& State);
+	// Newest revision first, either from source control or from a replay
+	void OnHistory(const TArray<TSharedRef<ISourceControlRevision>>& SourceControlRevisions);
+	void Prefetch();
+	TSharedPtr<FPropertyHistoryRevision> FindNextRevisionToLoad() const;
+	void FetchNext();
+	void RequestLoad();
+	void Load();
+	// Keeps at most PropertyHistory.MaxLoadedRevisions revisions loaded
+	void UnloadOldRevisions();
+
+	void AddError(const FString& NewError);
+	void Fail(const FString& NewError);
+	void Finish();
+};
@@ -2,6 +2,8 @@
 
 #include "PropertyHistoryProcessor.h"
 #include "PropertyHistoryUtilities.h"
+#include "PropertyHistoryRevisionData.h"
+#include "PropertyHistoryResolver.h"
 #include "Editor/MaterialEditor/Private/MaterialEditor.h"
 #include "Editor/UnrealEd/Private/Toolkits/SStandaloneAssetEditorToolkitHost.h"
 #include "MaterialEditor/DEditorDoubleVectorParameterValue.h"
@@ -18,7 +20,6 @@
 #include "MaterialEditor/MaterialEditorInstanceConstant.h"
 #include "MaterialEditor/PreviewMaterial.h"
 #include "Materials/MaterialInstanceConstant.h"
-#include "StructUtils/InstancedStruct.h"
 
 FPropertyHistoryProcessor::FPropertyHistoryProcessor(
 	UObject* Object,
@@ -44,9 +45,9 @@ bool FPropertyHistoryProcessor::Process(void*& Container)
 		const FPropertyData& Data = Properties[Index];
 		FPropertyData& ChildData = Properties[Index - 1];
 
-		if (const FStructProperty* StructProperty = CastField<FStructProperty>(Data.Property))
+		if (const IPropertyHistoryResolver* Resolver = FPropertyHistoryResolvers::Find(*Data.Property))
 		{
-			if (!ProcessStruct(Container, Data, ChildData))
+			if (!Resolve(*Resolver, Container, Data, ChildData))
 			{
 				return false;
 			}
@@ -207,134 +208,48 @@ bool FPropertyHistoryProcessor::PostProcess(void* Container)
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
-bool FPropertyHistoryProcessor::ProcessStruct(
+bool FPropertyHistoryProcessor::Resolve(
+	const IPropertyHistoryResolver& Resolver,
 	void*& Container,
 	const FPropertyData& Data,
 	FPropertyData& ChildData)
 {
-	static UScriptStruct* StampRefStruct = FindObject<UScriptStruct>(nullptr, TEXT("/Script/Voxel.VoxelStampRef"));
-	static UScriptStruct* StampStruct = FindObject<UScriptStruct>(nullptr, TEXT("/Script/Voxel.VoxelStamp"));
-	static UScriptStruct* ParameterOverridesStruct = FindObject<UScriptStruct>(nullptr, TEXT("/Script/VoxelGraph.VoxelParameterOverrides"));
+	const EPropertyHistoryResolverInputs Inputs = Resolver.GetInputs();
 
-	const FStructProperty* Property = CastField<FStructProperty>(Data.Property);
+	FPropertyHistoryResolveContext Context;
+	Context.Container = Container;
+	Context.Property = Data.Property;
+	Context.TargetStruct = TargetStruct;
 
-	if (Property->Struct == FInstancedStruct::StaticStruct())
+	if (EnumHasAnyFlags(Inputs, EPropertyHistoryResolverInputs::ChildProperty))
 	{
-		FInstancedStruct* InstancedStruct = Property->ContainerPtrToValuePtr<FInstancedStruct>(Container);
-		if (!InstancedStruct->IsValid())
-		{
-			return false;
-		}
-
-		if (const FStructProperty* ChildStructProperty = CastField<FStructProperty>(ChildData.Property))
-		{
-			if (ChildStructProperty->Struct != FInstancedStruct::StaticStruct() &&
-				ChildStructProperty->Struct != InstancedStruct->GetScriptStruct())
-			{
-				return false;
-			}
-		}
-
-		Container = InstancedStruct->GetMutableMemory();
-		if (!Container)
-		{
-			return false;
-		}
-
-		return true;
+		Context.ChildProperty = ChildData.Property;
 	}
-
-	if (Property->Struct == StampRefStruct)
+	if (EnumHasAnyFlags(Inputs, EPropertyHistoryResolverInputs::Guid))
 	{
-		struct FVoxelVirtualStructAccessor
-		{
-			uint8 Padding[16];
-			UScriptStruct* PrivateStruct;
-		};
-		struct FVoxelStampRefInnerAccessor : public TSharedFromThis<FVoxelStampRefInnerAccessor>
-		{
-			TSharedPtr<FVoxelVirtualStructAccessor> Stamp;
-		};
-
-		const TSharedRef<FVoxelStampRefInnerAccessor> StampRefAccessor = *Property->ContainerPtrToValuePtr<TSharedRef<FVoxelStampRefInnerAccessor>>(Container);
-		Container = StampRefAccessor->Stamp.Get();
-
-		// Necessary to get the struct type, if during changes struct type has changed.
-		// StampStruct should have alignment of 16
-		if (ensure(StampStruct->GetMinAlignment() == 16))
-		{
-			TargetStampStruct = StampRefAccessor->Stamp->PrivateStruct;
-		}
-		return true;
-	}
-
-	if (Property->Struct == ParameterOverridesStruct)
-	{
-		if (TargetStampStruct != Property->GetOwnerStruct())
-		{
-			return false;
-		}
-
 		if (!Guid.IsValid())
 		{
 			// Not supported
 			return false;
 		}
 
-		Container = Property->ContainerPtrToValuePtr<void>(Container);
-
-		UScriptStruct* ParameterValueOverrideStruct = nullptr;
-		for (const FMapProperty* MapProperty : TFieldRange<FMapProperty>(ParameterOverridesStruct))
-		{
-			const FStructProperty* StructKeyProperty = CastField<FStructProperty>(MapProperty->KeyProp);
-			const FStructProperty* StructValueProperty = CastField<FStructProperty>(MapProperty->ValueProp);
-			if (!StructKeyProperty ||
-				!StructValueProperty ||
-				StructKeyProperty->Struct != TBaseStructure<FGuid>::Get())
-			{
-				continue;
-			}
-
-			Container = MapProperty->ContainerPtrToValuePtr<void>(Container);
-
-			FScriptMapHelper MapHelper(MapProperty, Container);
-			const int32 PairIndex = MapHelper.FindMapIndexWithKey(&Guid);
-			if (PairIndex == -1)
-			{
-				return false;
-			}
-
-			Container = MapHelper.GetValuePtr(PairIndex);
-			ParameterValueOverrideStruct = StructValueProperty->Struct;
-			break;
-		}
-
-		// Reassign FVoxelPinValue, because it was from FStructOnScope, which had no proper offset
-		if (const FStructProperty* ChildStructProperty = CastField<FStructProperty>(ChildData.Property))
-		{
-			for (const FStructProperty* StructProperty : TFieldRange<FStructProperty>(ParameterValueOverrideStruct))
-			{
-				if (StructProperty->Struct == ChildStructProperty->Struct)
-				{
-					ChildData.Property = StructProperty;
-					break;
-				}
-			}
-		}
+		Context.Guid = Guid;
+	}
 
-		return true;
+	if (!Resolver.Resolve(Context))
+	{
+		return false;
 	}
 
-	/*if (Property->Struct->IsChildOf(StampStruct))
+	Container = Context.Container;
+	TargetStruct = Context.TargetStruct;
+
+	if (EnumHasAnyFlags(Inputs, EPropertyHistoryResolverInputs::ChildProperty))
 	{
-		if (TargetStampStruct != Property->Struct)
-		{
-			return false;
-		}
-	}*/
+		ChildData.Property = Context.ChildProperty;
+	}
 
-	Container = Property->ContainerPtrToValuePtr<void>(Container);
-	return true;
+	return Container != nullptr;
 }
 
 bool FPropertyHistoryProcessor::ProcessArray(
@@ -461,84 +376,185 @@ bool FPropertyHistoryProcessor::PreProcessMaterial(const UPreviewMaterial* Previ
 		return false;
 	}
 
-	TSharedPtr<SWidget> ParentWidget = DetailsView->GetParentWidget();
-	while (ParentWidget)
+	const TSharedPtr<FMaterialEditor> MaterialEditor = FindMaterialEditor(*DetailsView);
+	if (!MaterialEditor ||
+		MaterialEditor->Material != PreviewMaterial)
 	{
-		if (ParentWidget->GetTypeAsString() == "SStandaloneAssetEditorToolkitHost")
-		{
-			const TSharedPtr<FAssetEditorToolkit> Toolkit = PrivateAccess::HostedAssetEditorToolkit(*StaticCastSharedPtr<SStandaloneAssetEditorToolkitHost>(ParentWidget));
-			if (!Toolkit ||
-				Toolkit->GetToolkitFName() != "MaterialEditor")
-			{
-				return false;
-			}
+		return false;
+	}
 
-			const TSharedPtr<FMaterialEditor> MaterialEditor = StaticCastSharedPtr<FMaterialEditor>(Toolkit);
-			if (!MaterialEditor ||
-				MaterialEditor->Material != PreviewMaterial)
-			{
-				return false;
-			}
+	Object = MaterialEditor->OriginalMaterial;
+	return true;
+}
 
-			Object = MaterialEditor->OriginalMaterial;
-			return true;
-		}
+bool FPropertyHistoryProcessor::PreProcessMaterialExpression(const UMaterialExpression* MaterialExpression)
+{
+	UMaterialExpression* OriginalMaterialExpression = FindOriginalMaterialExpression(
+		*MaterialExpression,
+#if PROPERTY_HISTORY_ENGINE_VERSION >= 506
+		DetailsView.Get()
+#else
+		DetailsView
+#endif
+	);
 
-		ParentWidget = ParentWidget->GetParentWidget();
+	if (!OriginalMaterialExpression)
+	{
+		return false;
 	}
 
-	return false;
+	Object = OriginalMaterialExpression;
+	return true;
 }
 
-bool FPropertyHistoryProcessor::PreProcessMaterialExpression(const UMaterialExpression* MaterialExpression)
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+UMaterialExpression* FPropertyHistoryProcessor::FindOriginalMaterialExpression(
+	const UMaterialExpression& MaterialExpression,
+	const IDetailsView* InDetailsView)
 {
-	if (!MaterialExpression->GetOutermost()->HasAllFlags(RF_Transient))
+	if (!MaterialExpression.GetOutermost()->HasAllFlags(RF_Transient))
 	{
-		return true;
+		return const_cast<UMaterialExpression*>(&MaterialExpression);
 	}
 
-	if (!DetailsView)
+	if (!InDetailsView)
 	{
-		return false;
+		return nullptr;
 	}
 
-	TSharedPtr<SWidget> ParentWidget = DetailsView->GetParentWidget();
-	while (ParentWidget)
+	const TSharedPtr<FMaterialEditor> MaterialEditor = FindMaterialEditor(*InDetailsView);
+	if (!MaterialEditor ||
+		MaterialEditor->Material != MaterialExpression.GetTypedOuter<UMaterial>() ||
+		!MaterialEditor->OriginalMaterial)
 	{
-		if (ParentWidget->GetTypeAsString() == "SStandaloneAssetEditorToolkitHost")
+		return nullptr;
+	}
+
+	return FindMaterialExpression(*MaterialEditor->OriginalMaterial, MaterialExpression.MaterialExpressionGuid);
+}
+
+UMaterialExpression* FPropertyHistoryProcessor::FindMaterialExpression(const UMaterial& Material, const FGuid& MaterialExpressionGuid)
+{
+	struct FIndex
+	{
+		TMap<FGuid, TWeakObjectPtr<UMaterialExpression>> GuidToExpression;
+	};
+	static TMap<TWeakObjectPtr<const UMaterial>, FIndex> MaterialToIndex;
+
+	const auto Find = [&](const FIndex& Index) -> UMaterialExpression*
+	{
+		UMaterialExpression* Expression = Index.GuidToExpression.FindRef(MaterialExpressionGuid).Get();
+		if (!Expression ||
+			Expression->MaterialExpressionGuid != MaterialExpressionGuid)
 		{
-			const TSharedPtr<FAssetEditorToolkit> Toolkit = PrivateAccess::HostedAssetEditorToolkit(*StaticCastSharedPtr<SStandaloneAssetEditorToolkitHost>(ParentWidget));
-			if (!Toolkit ||
-				Toolkit->GetToolkitFName() != "MaterialEditor")
-			{
-				return false;
-			}
+			return nullptr;
+		}
 
-			const TSharedPtr<FMaterialEditor> MaterialEditor = StaticCastSharedPtr<FMaterialEditor>(Toolkit);
-			if (!MaterialEditor ||
-				MaterialEditor->Material != MaterialExpression->GetTypedOuter<UMaterial>())
+		return Expression;
+	};
+
+	if (const FIndex* Index = MaterialToIndex.Find(&Material))
+	{
+		if (UMaterialExpression* Expression = Find(*Index))
+		{
+			return Expression;
+		}
+
+		// Revisions never change, a miss is final
+		if (FPropertyHistoryRevisionData::IsRevisionPackage(*Material.GetPackage()))
+		{
+			return nullptr;
+		}
+	}
+	else
+	{
+		// Only clean up when adding new materials, revisions are regularly released
+		for (auto It = MaterialToIndex.CreateIterator(); It; ++It)
+		{
+			if (!It.Key().IsValid())
 			{
-				return false;
+				It.RemoveCurrent();
 			}
+		}
+	}
+
+	// (Re)build the index: the material might have been edited since
+	FIndex& Index = MaterialToIndex.FindOrAdd(&Material);
+	Index.GuidToExpression.Reset();
+
+	for (UMaterialExpression* Expression : Material.GetExpressions())
+	{
+		if (Expression)
+		{
+			Index.GuidToExpression.Add(Expression->MaterialExpressionGuid, Expression);
+		}
+	}
+
+	return Find(Index);
+}
+
+TSharedPtr<FMaterialEditor> FPropertyHistoryProcessor::FindMaterialEditor(const IDetailsView& InDetailsView)
+{
+	struct FCachedMaterialEditor
+	{
+		TWeakPtr<const SWidget> DetailsView;
+		TWeakPtr<FMaterialEditor> MaterialEditor;
+	};
+	// Details views don't move between editors: the parent widget chain is only walked once per details view
+	static TMap<const SWidget*, FCachedMaterialEditor> DetailsViewToMaterialEditor;
 
-			const UMaterial* Material = MaterialEditor->OriginalMaterial;
-			for (UMaterialExpression* Expression : Material->GetExpressions())
+	const TSharedRef<const SWidget> DetailsViewWidget = InDetailsView.AsShared();
+
+	if (const FCachedMaterialEditor* CachedMaterialEditor = DetailsViewToMaterialEditor.Find(&DetailsViewWidget.Get()))
+	{
+		if (CachedMaterialEditor->DetailsView.HasSameObject(&DetailsViewWidget.Get()))
+		{
+			return CachedMaterialEditor->MaterialEditor.Pin();
+		}
+	}
+
+	for (auto It = DetailsViewToMaterialEditor.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().DetailsView.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	const TSharedPtr<FMaterialEditor> MaterialEditor = INLINE_LAMBDA -> TSharedPtr<FMaterialEditor>
+	{
+		TSharedPtr<SWidget> ParentWidget = InDetailsView.GetParentWidget();
+		while (ParentWidget)
+		{
+			if (ParentWidget->GetTypeAsString() == "SStandaloneAssetEditorToolkitHost")
 			{
-				if (Expression &&
-					Expression->MaterialExpressionGuid == MaterialExpression->MaterialExpressionGuid)
+				const TSharedPtr<FAssetEditorToolkit> Toolkit = PrivateAccess::HostedAssetEditorToolkit(*StaticCastSharedPtr<SStandaloneAssetEditorToolkitHost>(ParentWidget));
+				if (!Toolkit ||
+					Toolkit->GetToolkitFName() != "MaterialEditor")
 				{
-					Object = Expression;
-					return true;
+					return nullptr;
 				}
+
+				return StaticCastSharedPtr<FMaterialEditor>(Toolkit);
 			}
 
-			return false;
+			ParentWidget = ParentWidget->GetParentWidget();
 		}
 
-		ParentWidget = ParentWidget->GetParentWidget();
+		return nullptr;
+	};
+
+	if (!MaterialEditor)
+	{
+		// Not parented yet, don't cache
+		return nullptr;
 	}
 
-	return false;
+	DetailsViewToMaterialEditor.Add(&DetailsViewWidget.Get(), { DetailsViewWidget, MaterialEditor });
+	return MaterialEditor;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -5,6 +5,9 @@
 #include "CoreMinimal.h"
 #include "PropertyHistoryUtilities.h"
 
+class FMaterialEditor;
+class IPropertyHistoryResolver;
+class UMaterial;
 class UPreviewMaterial;
 class UMaterialEditorInstanceConstant;
 
@@ -24,12 +27,20 @@ public:
 
 	bool Process(void*& Container);
 
+	// Material editor expressions are copies living in a transient preview material, this finds the asset one
+	static UMaterialExpression* FindOriginalMaterialExpression(
+		const UMaterialExpression& MaterialExpression,
+		const IDetailsView* InDetailsView);
+	// Indexed by MaterialExpressionGuid once per material
+	static UMaterialExpression* FindMaterialExpression(const UMaterial& Material, const FGuid& MaterialExpressionGuid);
+
 private:
 	bool PreProcess();
 	bool PostProcess(void* Container);
 
 private:
-	bool ProcessStruct(
+	bool Resolve(
+		const IPropertyHistoryResolver& Resolver,
 		void*& Container,
 		const FPropertyData& Data,
 		FPropertyData& ChildData);
@@ -45,6 +56,7 @@ private:
 
 private:
 	static FProperty* GetMaterialParameterComparisonProperty(const FArrayProperty* Property);
+	static TSharedPtr<FMaterialEditor> FindMaterialEditor(const IDetailsView& InDetailsView);
 
 public:
 	UObject* Object;
@@ -59,6 +71,7 @@ public:
 #endif
 
 private:
-	UScriptStruct* TargetStampStruct = nullptr;
+	// See FPropertyHistoryResolveContext::TargetStruct
+	const UScriptStruct* TargetStruct = nullptr;
 	bool bFetchMaterialParameterName = false;
 };
\ No newline at end of file
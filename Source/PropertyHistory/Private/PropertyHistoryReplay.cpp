@@ -0,0 +1,167 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryReplay.h"
+#include "ISourceControlModule.h"
+#include "ISourceControlRevision.h"
+#include "Containers/Ticker.h"
+#include "PropertyHistoryUtilities.h"
+#include "PropertyHistoryRevisionStore.h"
+
+static TAutoConsoleVariable<int32> CVarPropertyHistoryReplayMode(
+	TEXT("PropertyHistory.ReplayMode"),
+	0,
+	TEXT("0: use source control\n")
+	TEXT("1: use source control, and record its answers to PropertyHistory.ReplayDirectory\n")
+	TEXT("2: replay the answers recorded in PropertyHistory.ReplayDirectory, without any source control"));
+
+static TAutoConsoleVariable<FString> CVarPropertyHistoryReplayDirectory(
+	TEXT("PropertyHistory.ReplayDirectory"),
+	TEXT(""),
+	TEXT("Directory recordings are written to and replayed from. Relative to the project, defaults to Saved/PropertyHistory/Replay"));
+
+static TAutoConsoleVariable<float> CVarPropertyHistoryReplayQueryLatencyMs(
+	TEXT("PropertyHistory.ReplayQueryLatencyMs"),
+	200.f,
+	TEXT("Simulated latency of replayed history queries"));
+
+static TAutoConsoleVariable<float> CVarPropertyHistoryReplayFetchLatencyMs(
+	TEXT("PropertyHistory.ReplayFetchLatencyMs"),
+	50.f,
+	TEXT("Simulated latency of replayed revision downloads"));
+
+static TAutoConsoleVariable<float> CVarPropertyHistoryReplayFetchMegabytesPerSecond(
+	TEXT("PropertyHistory.ReplayFetchMegabytesPerSecond"),
+	0.f,
+	TEXT("Simulated bandwidth of replayed revision downloads. 0 for unlimited"));
+
+FPropertyHistoryReplaySettings FPropertyHistoryReplaySettings::Get()
+{
+	check(IsInGameThread());
+
+	FPropertyHistoryReplaySettings Settings;
+	Settings.Mode = EPropertyHistoryReplayMode(FMath::Clamp(CVarPropertyHistoryReplayMode.GetValueOnGameThread(), 0, 2));
+	if (Settings.Mode == EPropertyHistoryReplayMode::Disabled)
+	{
+		return Settings;
+	}
+
+	Settings.Directory = CVarPropertyHistoryReplayDirectory.GetValueOnGameThread();
+	if (Settings.Directory.IsEmpty())
+	{
+		Settings.Directory = FPaths::ProjectSavedDir() / "PropertyHistory" / "Replay";
+	}
+	else if (FPaths::IsRelative(Settings.Directory))
+	{
+		Settings.Directory = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), Settings.Directory);
+	}
+
+	Settings.QueryLatency = FMath::Max(0.f, CVarPropertyHistoryReplayQueryLatencyMs.GetValueOnGameThread()) / 1000.;
+	Settings.FetchLatency = FMath::Max(0.f, CVarPropertyHistoryReplayFetchLatencyMs.GetValueOnGameThread()) / 1000.;
+	Settings.FetchBytesPerSecond = FMath::Max(0.f, CVarPropertyHistoryReplayFetchMegabytesPerSecond.GetValueOnGameThread()) * 1024. * 1024.;
+	return Settings;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+bool FPropertyHistoryReplay::IsSourceControlEnabled()
+{
+	if (FPropertyHistoryReplaySettings::Get().Mode == EPropertyHistoryReplayMode::Replay)
+	{
+		return true;
+	}
+
+	return ISourceControlModule::Get().GetProvider().IsEnabled();
+}
+
+void FPropertyHistoryReplay::RecordHistory(
+	const FPropertyHistoryReplaySettings& Settings,
+	const FString& PackageFilename,
+	const TArray<TSharedRef<ISourceControlRevision>>& Revisions)
+{
+	check(IsInGameThread());
+	check(Settings.Mode == EPropertyHistoryReplayMode::Record);
+
+	FPropertyHistoryRevisionStore::SaveFile(Settings.Directory / "History" / GetKey(PackageFilename) + ".bin", Revisions);
+}
+
+void FPropertyHistoryReplay::ReplayHistory(
+	const FPropertyHistoryReplaySettings& Settings,
+	const FString& PackageFilename,
+	TFunction<void(const TOptional<TArray<TSharedRef<ISourceControlRevision>>>&)> OnCompleted)
+{
+	check(IsInGameThread());
+	check(Settings.Mode == EPropertyHistoryReplayMode::Replay);
+
+	TOptional<TArray<TSharedRef<ISourceControlRevision>>> Revisions;
+
+	const FString Path = Settings.Directory / "History" / GetKey(PackageFilename) + ".bin";
+	if (IFileManager::Get().FileExists(*Path))
+	{
+		Revisions.Emplace();
+		for (const TSharedRef<FPropertyHistoryStoredRevision>& Revision : FPropertyHistoryRevisionStore::LoadFile(Path))
+		{
+			Revisions->Add(Revision);
+		}
+	}
+
+	// Like providers, never answer from within the query
+	FTSTicker::GetCoreTicker().AddTicker(MakeLambdaDelegate([Revisions = MoveTemp(Revisions), OnCompleted = MoveTemp(OnCompleted)](float)
+	{
+		OnCompleted(Revisions);
+		return false;
+	}), float(Settings.QueryLatency));
+}
+
+void FPropertyHistoryReplay::RecordRevision(
+	const FPropertyHistoryReplaySettings& Settings,
+	const FString& PackageFilename,
+	const ISourceControlRevision& Revision,
+	const TConstArrayView64<uint8> Bytes)
+{
+	check(Settings.Mode == EPropertyHistoryReplayMode::Record);
+
+	const FString Path = Settings.Directory / "Revisions" / GetKey(PackageFilename, "@" + Revision.GetRevision()) + FPaths::GetExtension(PackageFilename, true);
+	FFileHelper::SaveArrayToFile(Bytes, *Path);
+}
+
+bool FPropertyHistoryReplay::ReplayRevision(
+	const FPropertyHistoryReplaySettings& Settings,
+	const FString& PackageFilename,
+	const ISourceControlRevision& Revision,
+	FString& OutFilename)
+{
+	check(Settings.Mode == EPropertyHistoryReplayMode::Replay);
+
+	const FString Path = Settings.Directory / "Revisions" / GetKey(PackageFilename, "@" + Revision.GetRevision()) + FPaths::GetExtension(PackageFilename, true);
+
+	const int64 FileSize = IFileManager::Get().FileSize(*Path);
+	if (FileSize < 0)
+	{
+		return false;
+	}
+
+	double Latency = Settings.FetchLatency;
+	if (Settings.FetchBytesPerSecond > 0.)
+	{
+		Latency += FileSize / Settings.FetchBytesPerSecond;
+	}
+	FPlatformProcess::Sleep(float(Latency));
+
+	// Providers write to a temp file the caller then owns
+	OutFilename = FPaths::CreateTempFilename(*FPaths::DiffDir(), TEXT("Replay-"), *FPaths::GetExtension(PackageFilename, true));
+	return IFileManager::Get().Copy(*OutFilename, *Path) == COPY_OK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FString FPropertyHistoryReplay::GetKey(const FString& PackageFilename, const FString& Suffix)
+{
+	FString RelativeFilename = FPaths::ConvertRelativePathToFull(PackageFilename);
+	FPaths::MakePathRelativeTo(RelativeFilename, *FPaths::ConvertRelativePathToFull(FPaths::ProjectDir()));
+
+	return FMD5::HashAnsiString(*(RelativeFilename + Suffix));
+}
@@ -0,0 +1,73 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ISourceControlRevision;
+
+enum class EPropertyHistoryReplayMode : uint8
+{
+	// Histories come from source control
+	Disabled,
+	// Histories come from source control, and are written to the replay directory
+	Record,
+	// Histories come from the replay directory, source control is never used
+	Replay
+};
+
+// Read on the game thread, then passed to the workers
+struct FPropertyHistoryReplaySettings
+{
+	EPropertyHistoryReplayMode Mode = EPropertyHistoryReplayMode::Disabled;
+	FString Directory;
+	// In seconds
+	double QueryLatency = 0.;
+	double FetchLatency = 0.;
+	// 0 if unlimited
+	double FetchBytesPerSecond = 0.;
+
+	// Must be called on the game thread
+	static FPropertyHistoryReplaySettings Get();
+};
+
+// Records what source control answered, history queries and revision bytes, and replays it with simulated latencies
+// Replays don't need any source control, and only depend on the recording and the settings:
+// fetching, caching and extraction can be benchmarked reproducibly on any machine, eg a Linux build machine
+struct FPropertyHistoryReplay
+{
+	// True if histories can be shown: either source control is enabled, or a recording is replayed
+	static bool IsSourceControlEnabled();
+
+	// Must be called on the game thread
+	static void RecordHistory(
+		const FPropertyHistoryReplaySettings& Settings,
+		const FString& PackageFilename,
+		const TArray<TSharedRef<ISourceControlRevision>>& Revisions);
+
+	// OnCompleted is called on the game thread after the query latency, with nothing if the package was not recorded
+	// Must be called on the game thread
+	static void ReplayHistory(
+		const FPropertyHistoryReplaySettings& Settings,
+		const FString& PackageFilename,
+		TFunction<void(const TOptional<TArray<TSharedRef<ISourceControlRevision>>>&)> OnCompleted);
+
+	// Can be called from any thread
+	static void RecordRevision(
+		const FPropertyHistoryReplaySettings& Settings,
+		const FString& PackageFilename,
+		const ISourceControlRevision& Revision,
+		TConstArrayView64<uint8> Bytes);
+
+	// Same contract as ISourceControlRevision::Get: writes the revision to a temp file, blocking for the fetch latency
+	// Can be called from any thread
+	static bool ReplayRevision(
+		const FPropertyHistoryReplaySettings& Settings,
+		const FString& PackageFilename,
+		const ISourceControlRevision& Revision,
+		FString& OutFilename);
+
+private:
+	// Relative to the project, so that recordings can be replayed from another checkout
+	static FString GetKey(const FString& PackageFilename, const FString& Suffix = {});
+};
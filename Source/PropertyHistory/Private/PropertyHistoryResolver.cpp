@@ -0,0 +1,206 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryResolver.h"
+#include "StructUtils/InstancedStruct.h"
+
+class FPropertyHistoryInstancedStructResolver : public IPropertyHistoryResolver
+{
+public:
+	//~ Begin IPropertyHistoryResolver Interface
+	virtual EPropertyHistoryResolverInputs GetInputs() const override
+	{
+		return EPropertyHistoryResolverInputs::ChildProperty;
+	}
+
+	virtual bool Resolve(FPropertyHistoryResolveContext& Context) const override
+	{
+		FInstancedStruct* InstancedStruct = Context.Property->ContainerPtrToValuePtr<FInstancedStruct>(Context.Container);
+		if (!InstancedStruct->IsValid())
+		{
+			return false;
+		}
+
+		if (const FStructProperty* ChildStructProperty = CastField<FStructProperty>(Context.ChildProperty))
+		{
+			if (ChildStructProperty->Struct != FInstancedStruct::StaticStruct() &&
+				ChildStructProperty->Struct != InstancedStruct->GetScriptStruct())
+			{
+				return false;
+			}
+		}
+
+		Context.Container = InstancedStruct->GetMutableMemory();
+		return Context.Container != nullptr;
+	}
+	//~ End IPropertyHistoryResolver Interface
+};
+
+class FPropertyHistoryVoxelStampRefResolver : public IPropertyHistoryResolver
+{
+public:
+	//~ Begin IPropertyHistoryResolver Interface
+	virtual bool Resolve(FPropertyHistoryResolveContext& Context) const override
+	{
+		static UScriptStruct* StampStruct = FindObject<UScriptStruct>(nullptr, TEXT("/Script/Voxel.VoxelStamp"));
+
+		struct FVoxelVirtualStructAccessor
+		{
+			uint8 Padding[16];
+			UScriptStruct* PrivateStruct;
+		};
+		struct FVoxelStampRefInnerAccessor : public TSharedFromThis<FVoxelStampRefInnerAccessor>
+		{
+			TSharedPtr<FVoxelVirtualStructAccessor> Stamp;
+		};
+
+		const TSharedRef<FVoxelStampRefInnerAccessor> StampRefAccessor = *Context.Property->ContainerPtrToValuePtr<TSharedRef<FVoxelStampRefInnerAccessor>>(Context.Container);
+		Context.Container = StampRefAccessor->Stamp.Get();
+
+		// Necessary to get the struct type, if during changes struct type has changed.
+		// StampStruct should have alignment of 16
+		if (ensure(StampStruct) &&
+			ensure(StampStruct->GetMinAlignment() == 16))
+		{
+			Context.TargetStruct = StampRefAccessor->Stamp->PrivateStruct;
+		}
+		return true;
+	}
+	//~ End IPropertyHistoryResolver Interface
+};
+
+class FPropertyHistoryVoxelParameterOverridesResolver : public IPropertyHistoryResolver
+{
+public:
+	//~ Begin IPropertyHistoryResolver Interface
+	virtual EPropertyHistoryResolverInputs GetInputs() const override
+	{
+		return
+			EPropertyHistoryResolverInputs::ChildProperty |
+			EPropertyHistoryResolverInputs::Guid;
+	}
+
+	virtual bool Resolve(FPropertyHistoryResolveContext& Context) const override
+	{
+		const FStructProperty* Property = CastField<FStructProperty>(Context.Property);
+		if (Context.TargetStruct != Property->GetOwnerStruct())
+		{
+			return false;
+		}
+
+		Context.Container = Property->ContainerPtrToValuePtr<void>(Context.Container);
+
+		UScriptStruct* ParameterValueOverrideStruct = nullptr;
+		for (const FMapProperty* MapProperty : TFieldRange<FMapProperty>(Property->Struct))
+		{
+			const FStructProperty* StructKeyProperty = CastField<FStructProperty>(MapProperty->KeyProp);
+			const FStructProperty* StructValueProperty = CastField<FStructProperty>(MapProperty->ValueProp);
+			if (!StructKeyProperty ||
+				!StructValueProperty ||
+				StructKeyProperty->Struct != TBaseStructure<FGuid>::Get())
+			{
+				continue;
+			}
+
+			Context.Container = MapProperty->ContainerPtrToValuePtr<void>(Context.Container);
+
+			FScriptMapHelper MapHelper(MapProperty, Context.Container);
+			const int32 PairIndex = MapHelper.FindMapIndexWithKey(&Context.Guid);
+			if (PairIndex == -1)
+			{
+				return false;
+			}
+
+			Context.Container = MapHelper.GetValuePtr(PairIndex);
+			ParameterValueOverrideStruct = StructValueProperty->Struct;
+			break;
+		}
+
+		if (!ParameterValueOverrideStruct)
+		{
+			return false;
+		}
+
+		// Reassign FVoxelPinValue, because it was from FStructOnScope, which had no proper offset
+		if (const FStructProperty* ChildStructProperty = CastField<FStructProperty>(Context.ChildProperty))
+		{
+			for (const FStructProperty* StructProperty : TFieldRange<FStructProperty>(ParameterValueOverrideStruct))
+			{
+				if (StructProperty->Struct == ChildStructProperty->Struct)
+				{
+					Context.ChildProperty = StructProperty;
+					break;
+				}
+			}
+		}
+
+		return true;
+	}
+	//~ End IPropertyHistoryResolver Interface
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+namespace PropertyHistoryResolver
+{
+	struct FRegistry
+	{
+		TMap<FTopLevelAssetPath, TSharedPtr<const IPropertyHistoryResolver>> StructPathToResolver;
+		TMap<const FFieldClass*, TSharedPtr<const IPropertyHistoryResolver>> FieldClassToResolver;
+	};
+
+	FRegistry& GetRegistry()
+	{
+		static FRegistry Registry = []
+		{
+			FRegistry Result;
+			Result.StructPathToResolver.Add(FInstancedStruct::StaticStruct()->GetStructPathName(), MakeShared<FPropertyHistoryInstancedStructResolver>());
+			Result.StructPathToResolver.Add(FTopLevelAssetPath("/Script/Voxel", "VoxelStampRef"), MakeShared<FPropertyHistoryVoxelStampRefResolver>());
+			Result.StructPathToResolver.Add(FTopLevelAssetPath("/Script/VoxelGraph", "VoxelParameterOverrides"), MakeShared<FPropertyHistoryVoxelParameterOverridesResolver>());
+			return Result;
+		}();
+		return Registry;
+	}
+}
+
+void FPropertyHistoryResolvers::RegisterStruct(const FTopLevelAssetPath& StructPath, const TSharedRef<const IPropertyHistoryResolver>& Resolver)
+{
+	check(IsInGameThread());
+	PropertyHistoryResolver::GetRegistry().StructPathToResolver.Add(StructPath, Resolver);
+}
+
+void FPropertyHistoryResolvers::RegisterFieldClass(const FFieldClass& FieldClass, const TSharedRef<const IPropertyHistoryResolver>& Resolver)
+{
+	check(IsInGameThread());
+	PropertyHistoryResolver::GetRegistry().FieldClassToResolver.Add(&FieldClass, Resolver);
+}
+
+void FPropertyHistoryResolvers::UnregisterStruct(const FTopLevelAssetPath& StructPath)
+{
+	check(IsInGameThread());
+	PropertyHistoryResolver::GetRegistry().StructPathToResolver.Remove(StructPath);
+}
+
+void FPropertyHistoryResolvers::UnregisterFieldClass(const FFieldClass& FieldClass)
+{
+	check(IsInGameThread());
+	PropertyHistoryResolver::GetRegistry().FieldClassToResolver.Remove(&FieldClass);
+}
+
+const IPropertyHistoryResolver* FPropertyHistoryResolvers::Find(const FProperty& Property)
+{
+	const PropertyHistoryResolver::FRegistry& Registry = PropertyHistoryResolver::GetRegistry();
+
+	if (const FStructProperty* StructProperty = CastField<FStructProperty>(&Property))
+	{
+		return Registry.StructPathToResolver.FindRef(StructProperty->Struct->GetStructPathName()).Get();
+	}
+
+	if (Registry.FieldClassToResolver.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	return Registry.FieldClassToResolver.FindRef(Property.GetClass()).Get();
+}
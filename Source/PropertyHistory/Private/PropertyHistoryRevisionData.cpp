@@ -0,0 +1,433 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryRevisionData.h"
+#include "ISourceControlRevision.h"
+#include "PropertyHistoryReplay.h"
+#include "PropertyHistoryGitLfs.h"
+#include "PropertyHistorySharedCache.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/PackageName.h"
+#include "Serialization/ArchiveProxy.h"
+#include "Serialization/LargeMemoryReader.h"
+#include "UObject/LinkerLoad.h"
+#include "UObject/UObjectThreadContext.h"
+#include "UObject/LinkerInstancingContext.h"
+
+namespace PropertyHistoryRevisionData
+{
+	const FString PackageRoot = "/Temp/PropertyHistory/";
+
+	FPackagePath MakeTempPackagePath(const FString& TempPackageName, const FString& PackageFilename)
+	{
+		FPackagePath TempPackagePath = FPackagePath::FromPackageNameChecked(TempPackageName);
+		TempPackagePath.SetHeaderExtension(
+			FPaths::GetExtension(PackageFilename, true) == FPackageName::GetMapPackageExtension()
+			? EPackageExtension::Map
+			: EPackageExtension::Asset);
+		return TempPackagePath;
+	}
+
+	// Reads exports of a linker without letting it resolve references: it would load their packages
+	// References are found among loaded objects, exports among the objects created from the revision in its temp package
+	// Exports of the current package are never used, they might have changed since: exports that weren't created stay null
+	class FExportReader : public FArchiveProxy
+	{
+	public:
+		explicit FExportReader(FLinkerLoad& Linker)
+			: FArchiveProxy(Linker)
+			, Linker(Linker)
+		{
+		}
+
+		//~ Begin FArchive Interface
+		virtual FArchive& operator<<(UObject*& Value) override
+		{
+			FPackageIndex Index;
+			InnerArchive << Index;
+
+			Value = nullptr;
+			if (Index.IsNull())
+			{
+				return *this;
+			}
+
+			// Export paths are in the linker root, ie the temp package of the revision
+			Value = FindObject<UObject>(nullptr, *Linker.GetPathName(Index));
+			return *this;
+		}
+		virtual FArchive& operator<<(FObjectPtr& Value) override
+		{
+			UObject* Object = nullptr;
+			*this << Object;
+			Value = Object;
+			return *this;
+		}
+		virtual FArchive& operator<<(FWeakObjectPtr& Value) override
+		{
+			UObject* Object = nullptr;
+			*this << Object;
+			Value = Object;
+			return *this;
+		}
+		//~ End FArchive Interface
+
+	private:
+		FLinkerLoad& Linker;
+	};
+}
+
+FPropertyHistoryRevisionData::~FPropertyHistoryRevisionData()
+{
+	// Region must be unmapped before the handle is closed
+	MappedRegion.Reset();
+	MappedHandle.Reset();
+}
+
+FString FPropertyHistoryRevisionData::GetCacheDirectory()
+{
+	check(IsInGameThread());
+
+	FString Directory;
+	if (!GConfig->GetString(TEXT("PropertyHistory"), TEXT("RevisionCacheDirectory"), Directory, GEditorPerProjectIni))
+	{
+		// Next to the revision store, so that stored histories load without asking source control
+		return FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / "PropertyHistory" / "Revisions");
+	}
+
+	if (Directory.IsEmpty())
+	{
+		return {};
+	}
+
+	if (FPaths::IsRelative(Directory))
+	{
+		Directory = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), Directory);
+	}
+	return Directory;
+}
+
+FString FPropertyHistoryRevisionData::GetCacheKey(const FString& PackageFilename, const ISourceControlRevision& Revision)
+{
+	return FMD5::HashAnsiString(*(FPaths::ConvertRelativePathToFull(PackageFilename) + "@" + Revision.GetRevision()));
+}
+
+TSharedPtr<FPropertyHistoryRevisionData> FPropertyHistoryRevisionData::Fetch(
+	const FString& PackageFilename,
+	const ISourceControlRevision& Revision,
+	const FString& CacheDirectory,
+	const FString& SharedCacheDirectory,
+	const FPropertyHistoryGitLfs& GitLfs,
+	const FPropertyHistoryReplaySettings& ReplaySettings)
+{
+	if (ReplaySettings.Mode == EPropertyHistoryReplayMode::Replay)
+	{
+		// Replays only depend on the recording: never read the caches, nor fill them with replayed revisions
+		FString TempFileName;
+		if (!FPropertyHistoryReplay::ReplayRevision(ReplaySettings, PackageFilename, Revision, TempFileName))
+		{
+			return nullptr;
+		}
+
+		const TSharedPtr<FPropertyHistoryRevisionData> Data = LoadFile(TempFileName);
+		IFileManager::Get().Delete(*TempFileName, false, false, true);
+		return Data;
+	}
+
+	const TSharedPtr<FPropertyHistoryRevisionData> Data = FetchFromSourceControl(PackageFilename, Revision, CacheDirectory, SharedCacheDirectory, GitLfs);
+
+	// Whatever answered, so that replays never need source control
+	if (Data &&
+		ReplaySettings.Mode == EPropertyHistoryReplayMode::Record)
+	{
+		FPropertyHistoryReplay::RecordRevision(ReplaySettings, PackageFilename, Revision, Data->GetView());
+	}
+	return Data;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+TSharedPtr<FPropertyHistoryRevisionData> FPropertyHistoryRevisionData::FetchFromSourceControl(
+	const FString& PackageFilename,
+	const ISourceControlRevision& Revision,
+	const FString& CacheDirectory,
+	const FString& SharedCacheDirectory,
+	const FPropertyHistoryGitLfs& GitLfs)
+{
+	// Not looked up in the shared cache: local hits stay off the network, see FPropertyHistoryChangeIndex::ShareHashTrees
+	if (const TSharedPtr<FPropertyHistoryRevisionData> Data = FindLocal(PackageFilename, Revision, CacheDirectory, GitLfs))
+	{
+		return Data;
+	}
+
+	FString CachePath;
+	if (!CacheDirectory.IsEmpty())
+	{
+		CachePath = CacheDirectory / GetCacheKey(PackageFilename, Revision) + FPaths::GetExtension(PackageFilename, true);
+	}
+
+	// Someone in the team or the build machine might already have fetched it
+	if (const TSharedPtr<FPropertyHistoryRevisionData> Data = FPropertyHistorySharedCache::FindRevision(SharedCacheDirectory, PackageFilename, Revision, CachePath))
+	{
+		return Data;
+	}
+
+	// Source control providers can only write revisions to disk
+	FString TempFileName;
+	if (!Revision.Get(TempFileName, EConcurrency::Asynchronous) ||
+		TempFileName.IsEmpty())
+	{
+		return nullptr;
+	}
+
+	TSharedPtr<FPropertyHistoryRevisionData> Data;
+	if (!CachePath.IsEmpty())
+	{
+		IFileManager::Get().MakeDirectory(*CacheDirectory, true);
+
+		// Moving is atomic on the same volume and avoids reading the temp file only to write it back
+		// If the move fails, another editor likely cached the same revision first
+		IFileManager::Get().Move(*CachePath, *TempFileName, false, false, false, true);
+
+		Data = MapFile(CachePath);
+	}
+
+	if (!Data)
+	{
+		Data = LoadFile(TempFileName);
+	}
+	IFileManager::Get().Delete(*TempFileName, false, false, true);
+
+	if (Data)
+	{
+		Data->ContentHash = FPropertyHistorySharedCache::AddRevision(SharedCacheDirectory, PackageFilename, Revision, Data->GetView());
+	}
+	return Data;
+}
+
+TSharedPtr<FPropertyHistoryRevisionData> FPropertyHistoryRevisionData::FindLocal(
+	const FString& PackageFilename,
+	const ISourceControlRevision& Revision,
+	const FString& CacheDirectory,
+	const FPropertyHistoryGitLfs& GitLfs)
+{
+	if (!CacheDirectory.IsEmpty())
+	{
+		if (const TSharedPtr<FPropertyHistoryRevisionData> Data = MapFile(CacheDirectory / GetCacheKey(PackageFilename, Revision) + FPaths::GetExtension(PackageFilename, true)))
+		{
+			return Data;
+		}
+	}
+
+	// Git LFS keeps every object it fetched: no need to copy them to the revision cache
+	return GitLfs.Fetch(PackageFilename, Revision.GetRevision());
+}
+
+TSharedPtr<FPropertyHistoryRevisionData> FPropertyHistoryRevisionData::MapFile(const FString& Path)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.FileExists(*Path))
+	{
+		return nullptr;
+	}
+
+	TUniquePtr<IMappedFileHandle> MappedHandle(PlatformFile.OpenMapped(*Path));
+	if (!MappedHandle ||
+		MappedHandle->GetFileSize() == 0)
+	{
+		return nullptr;
+	}
+
+	TUniquePtr<IMappedFileRegion> MappedRegion(MappedHandle->MapRegion(0, MappedHandle->GetFileSize(), true));
+	if (!MappedRegion)
+	{
+		return nullptr;
+	}
+
+	const TSharedRef<FPropertyHistoryRevisionData> Data = MakeShared<FPropertyHistoryRevisionData>();
+	Data->MappedHandle = MoveTemp(MappedHandle);
+	Data->MappedRegion = MoveTemp(MappedRegion);
+	return Data;
+}
+
+TSharedPtr<FPropertyHistoryRevisionData> FPropertyHistoryRevisionData::LoadFile(const FString& Path)
+{
+	const TSharedRef<FPropertyHistoryRevisionData> Data = MakeShared<FPropertyHistoryRevisionData>();
+	if (!FFileHelper::LoadFileToArray(Data->Bytes, *Path) ||
+		Data->Bytes.Num() == 0)
+	{
+		return nullptr;
+	}
+	return Data;
+}
+
+TConstArrayView64<uint8> FPropertyHistoryRevisionData::GetView() const
+{
+	if (MappedRegion)
+	{
+		return TConstArrayView64<uint8>(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize());
+	}
+
+	return Bytes;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+bool FPropertyHistoryRevisionData::IsRevisionPackage(const UPackage& Package)
+{
+	return Package.GetName().StartsWith(PropertyHistoryRevisionData::PackageRoot);
+}
+
+UPackage* FPropertyHistoryRevisionData::LoadPackage(
+	const FString& PackageFilename,
+	const ISourceControlRevision& Revision) const
+{
+	check(IsInGameThread());
+
+	const FString TempPackageName = PropertyHistoryRevisionData::PackageRoot + FPaths::GetBaseFilename(PackageFilename) + "_" + GetCacheKey(PackageFilename, Revision);
+
+	// Revisions never change, no need to load them twice
+	if (UPackage* ExistingPackage = FindPackage(nullptr, *TempPackageName))
+	{
+		if (ExistingPackage->IsFullyLoaded())
+		{
+			return ExistingPackage;
+		}
+	}
+
+	const FPackagePath TempPackagePath = PropertyHistoryRevisionData::MakeTempPackagePath(TempPackageName, PackageFilename);
+	const FPackagePath OriginalPackagePath = FPackagePath::FromLocalPath(Revision.GetFilename());
+
+	UPackage* TempPackage = CreatePackage(*TempPackageName);
+
+	FLinkerInstancingContext InstancingContext;
+	InstancingContext.AddPackageMapping(OriginalPackagePath.GetPackageFName(), TempPackage->GetFName());
+
+	const TConstArrayView64<uint8> View = GetView();
+
+	// Owned by the linker
+	FLargeMemoryReader* Reader = new FLargeMemoryReader(
+		View.GetData(),
+		View.Num(),
+		ELargeMemoryReaderFlags::Persistent,
+		*TempPackageName);
+
+	UPackage* Package = ::LoadPackage(
+		TempPackage,
+		TempPackagePath,
+		LOAD_ForDiff | LOAD_DisableCompileOnLoad | LOAD_DisableEngineVersionChecks,
+		Reader,
+		&InstancingContext);
+
+	if (Package)
+	{
+		// The reader points to our bytes: detach the linker while they are still alive
+		ResetLoaders(Package);
+	}
+
+	return Package;
+}
+
+UPackage* FPropertyHistoryRevisionData::LoadClassDefaults(
+	const FString& PackageFilename,
+	const ISourceControlRevision& Revision,
+	UClass& Class) const
+{
+	check(IsInGameThread());
+
+	const FString TempPackageName = PropertyHistoryRevisionData::PackageRoot + FPaths::GetBaseFilename(PackageFilename) + "_" + GetCacheKey(PackageFilename, Revision) + "_Defaults";
+
+	// Named after the current class defaults, so that they are found no matter how the Blueprint was named back then
+	const UObject* ClassDefaults = Class.GetDefaultObject();
+	const FName DefaultsName = ClassDefaults->GetFName();
+
+	if (UPackage* ExistingPackage = FindPackage(nullptr, *TempPackageName))
+	{
+		if (StaticFindObjectFast(nullptr, ExistingPackage, DefaultsName))
+		{
+			return ExistingPackage;
+		}
+	}
+
+	const FPackagePath OriginalPackagePath = FPackagePath::FromLocalPath(Revision.GetFilename());
+
+	UPackage* TempPackage = CreatePackage(*TempPackageName);
+
+	FLinkerInstancingContext InstancingContext;
+	InstancingContext.AddPackageMapping(OriginalPackagePath.GetPackageFName(), TempPackage->GetFName());
+
+	const TConstArrayView64<uint8> View = GetView();
+
+	// Owned by the linker
+	FLargeMemoryReader* Reader = new FLargeMemoryReader(
+		View.GetData(),
+		View.Num(),
+		ELargeMemoryReaderFlags::Persistent,
+		*TempPackageName);
+
+	const TRefCountPtr<FUObjectSerializeContext> LoadContext = FUObjectThreadContext::Get().GetSerializeContext();
+	BeginLoad(LoadContext);
+
+	// No verify: imports are never loaded, only the package summary, names & maps are read
+	FLinkerLoad* Linker = FLinkerLoad::CreateLinker(
+		LoadContext,
+		TempPackage,
+		PropertyHistoryRevisionData::MakeTempPackagePath(TempPackageName, PackageFilename),
+		LOAD_ForDiff | LOAD_NoVerify | LOAD_DisableCompileOnLoad | LOAD_DisableEngineVersionChecks,
+		Reader,
+		&InstancingContext);
+
+	UObject* Defaults = nullptr;
+	if (Linker)
+	{
+		const FObjectExport* DefaultsExport = Linker->ExportMap.FindByPredicate([](const FObjectExport& Export)
+		{
+			return
+				(Export.ObjectFlags & RF_ClassDefaultObject) &&
+				Export.OuterIndex.IsNull() &&
+				!Export.ObjectName.ToString().StartsWith("Default__SKEL_");
+		});
+
+		if (DefaultsExport &&
+			DefaultsExport->SerialSize > 0)
+		{
+			Defaults = NewObject<UObject>(TempPackage, &Class, DefaultsName, RF_Transient | RF_ArchetypeObject);
+
+			// Class defaults are serialized as a delta to the parent class defaults: nothing of the current defaults may remain
+			const UClass* SuperClass = Class.GetSuperClass();
+			const UObject* SuperDefaults = SuperClass ? SuperClass->GetDefaultObject() : nullptr;
+			for (const FProperty* Property : TFieldRange<FProperty>(&Class))
+			{
+				if (!SuperDefaults ||
+					!SuperClass->IsChildOf(Property->GetOwnerClass()))
+				{
+					// Declared by the Blueprint: no parent default, so serialized unless the variable did not exist in that revision
+					Property->ClearValue_InContainer(Defaults);
+					continue;
+				}
+
+				// Instanced subobjects belong to the parent defaults
+				if (Property->HasAnyPropertyFlags(CPF_Transient | CPF_InstancedReference | CPF_ContainsInstancedReference))
+				{
+					continue;
+				}
+
+				Property->CopyCompleteValue_InContainer(Defaults, SuperDefaults);
+			}
+
+			PropertyHistoryRevisionData::FExportReader ExportReader(*Linker);
+			ExportReader.Seek(DefaultsExport->SerialOffset);
+			Defaults->SerializeScriptProperties(ExportReader);
+		}
+	}
+
+	EndLoad(LoadContext, nullptr);
+
+	// The reader points to our bytes: detach the linker while they are still alive
+	ResetLoaders(TempPackage);
+
+	return Defaults ? TempPackage : nullptr;
+}
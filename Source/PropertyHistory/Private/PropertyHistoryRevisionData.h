@@ -0,0 +1,81 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ISourceControlRevision;
+class IMappedFileHandle;
+class IMappedFileRegion;
+struct FPropertyHistoryReplaySettings;
+struct FPropertyHistoryGitLfs;
+
+// Bytes of a package revision, either owned or memory-mapped from the revision cache
+// Packages are loaded straight from these bytes, without going through a temp file
+class FPropertyHistoryRevisionData
+{
+public:
+	FPropertyHistoryRevisionData() = default;
+	~FPropertyHistoryRevisionData();
+
+	// Configured through [PropertyHistory] RevisionCacheDirectory in the editor per project ini, Saved/PropertyHistory/Revisions if not set
+	// Empty if set to an empty directory, ie disabled
+	// Must be called on the game thread
+	static FString GetCacheDirectory();
+	static FString GetCacheKey(const FString& PackageFilename, const ISourceControlRevision& Revision);
+
+	// Can be called from any thread
+	static TSharedPtr<FPropertyHistoryRevisionData> Fetch(
+		const FString& PackageFilename,
+		const ISourceControlRevision& Revision,
+		const FString& CacheDirectory,
+		const FString& SharedCacheDirectory,
+		const FPropertyHistoryGitLfs& GitLfs,
+		const FPropertyHistoryReplaySettings& ReplaySettings);
+	// Only looks in the revision cache and the local Git LFS store, never downloads anything
+	// Can be called from any thread
+	static TSharedPtr<FPropertyHistoryRevisionData> FindLocal(
+		const FString& PackageFilename,
+		const ISourceControlRevision& Revision,
+		const FString& CacheDirectory,
+		const FPropertyHistoryGitLfs& GitLfs);
+
+	// True for packages loaded by LoadPackage
+	static bool IsRevisionPackage(const UPackage& Package);
+
+	static TSharedPtr<FPropertyHistoryRevisionData> MapFile(const FString& Path);
+	static TSharedPtr<FPropertyHistoryRevisionData> LoadFile(const FString& Path);
+
+	TConstArrayView64<uint8> GetView() const;
+
+	// Must be called on the game thread
+	UPackage* LoadPackage(
+		const FString& PackageFilename,
+		const ISourceControlRevision& Revision) const;
+
+	// Only reads the class default object of a Blueprint package, onto the parent class defaults
+	// Neither the historical class nor anything it depends on is loaded or compiled
+	// Must be called on the game thread
+	UPackage* LoadClassDefaults(
+		const FString& PackageFilename,
+		const ISourceControlRevision& Revision,
+		UClass& Class) const;
+
+public:
+	// Hash of the bytes in the shared cache, empty if not in it
+	// Never set for revisions found locally, these are only hashed once something of them is shared
+	FString ContentHash;
+
+private:
+	TArray64<uint8> Bytes;
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	// Revision cache, Git LFS, shared cache, then the provider
+	static TSharedPtr<FPropertyHistoryRevisionData> FetchFromSourceControl(
+		const FString& PackageFilename,
+		const ISourceControlRevision& Revision,
+		const FString& CacheDirectory,
+		const FString& SharedCacheDirectory,
+		const FPropertyHistoryGitLfs& GitLfs);
+};
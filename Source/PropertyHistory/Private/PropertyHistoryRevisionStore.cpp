@@ -0,0 +1,212 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryRevisionStore.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+FPropertyHistoryStoredRevision::FPropertyHistoryStoredRevision(const ISourceControlRevision& Other)
+	: Filename(Other.GetFilename())
+	, Revision(Other.GetRevision())
+	, Description(Other.GetDescription())
+	, UserName(Other.GetUserName())
+	, ClientSpec(Other.GetClientSpec())
+	, Action(Other.GetAction())
+	, Date(Other.GetDate())
+	, RevisionNumber(Other.GetRevisionNumber())
+	, CheckInIdentifier(Other.GetCheckInIdentifier())
+	, FileSize(Other.GetFileSize())
+{
+	if (const TSharedPtr<ISourceControlRevision> OtherBranchSource = Other.GetBranchSource())
+	{
+		BranchSource = MakeShared<FPropertyHistoryStoredRevision>(*OtherBranchSource);
+	}
+}
+
+FArchive& operator<<(FArchive& Ar, FPropertyHistoryStoredRevision& StoredRevision)
+{
+	Ar << StoredRevision.Filename;
+	Ar << StoredRevision.Revision;
+	Ar << StoredRevision.Description;
+	Ar << StoredRevision.UserName;
+	Ar << StoredRevision.ClientSpec;
+	Ar << StoredRevision.Action;
+	Ar << StoredRevision.Date;
+	Ar << StoredRevision.RevisionNumber;
+	Ar << StoredRevision.CheckInIdentifier;
+	Ar << StoredRevision.FileSize;
+
+	bool bHasBranchSource = StoredRevision.BranchSource.IsValid();
+	Ar << bHasBranchSource;
+
+	if (bHasBranchSource)
+	{
+		if (Ar.IsLoading())
+		{
+			StoredRevision.BranchSource = MakeShared<FPropertyHistoryStoredRevision>();
+		}
+		Ar << *StoredRevision.BranchSource;
+	}
+	return Ar;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+bool FPropertyHistoryStoredRevision::Get(FString& InOutFilename, EConcurrency::Type InConcurrency) const
+{
+	return false;
+}
+
+bool FPropertyHistoryStoredRevision::GetAnnotated(TArray<FAnnotationLine>& OutLines) const
+{
+	return false;
+}
+
+bool FPropertyHistoryStoredRevision::GetAnnotated(FString& InOutFilename) const
+{
+	return false;
+}
+
+const FString& FPropertyHistoryStoredRevision::GetFilename() const
+{
+	return Filename;
+}
+
+int32 FPropertyHistoryStoredRevision::GetRevisionNumber() const
+{
+	return RevisionNumber;
+}
+
+const FString& FPropertyHistoryStoredRevision::GetRevision() const
+{
+	return Revision;
+}
+
+const FString& FPropertyHistoryStoredRevision::GetDescription() const
+{
+	return Description;
+}
+
+const FString& FPropertyHistoryStoredRevision::GetUserName() const
+{
+	return UserName;
+}
+
+const FString& FPropertyHistoryStoredRevision::GetClientSpec() const
+{
+	return ClientSpec;
+}
+
+const FString& FPropertyHistoryStoredRevision::GetAction() const
+{
+	return Action;
+}
+
+TSharedPtr<ISourceControlRevision> FPropertyHistoryStoredRevision::GetBranchSource() const
+{
+	return BranchSource;
+}
+
+const FDateTime& FPropertyHistoryStoredRevision::GetDate() const
+{
+	return Date;
+}
+
+int32 FPropertyHistoryStoredRevision::GetCheckInIdentifier() const
+{
+	return CheckInIdentifier;
+}
+
+int32 FPropertyHistoryStoredRevision::GetFileSize() const
+{
+	return FileSize;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+namespace PropertyHistoryRevisionStore
+{
+	constexpr uint32 Magic = 0x50485253;
+	constexpr int32 Version = 2;
+}
+
+TArray<TSharedRef<FPropertyHistoryStoredRevision>> FPropertyHistoryRevisionStore::Load(const FString& PackageFilename)
+{
+	return LoadFile(GetPath(PackageFilename));
+}
+
+void FPropertyHistoryRevisionStore::Save(const FString& PackageFilename, const TArray<TSharedRef<ISourceControlRevision>>& Revisions)
+{
+	SaveFile(GetPath(PackageFilename), Revisions);
+}
+
+TArray<TSharedRef<FPropertyHistoryStoredRevision>> FPropertyHistoryRevisionStore::LoadFile(const FString& Path)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path, FILEREAD_Silent))
+	{
+		return {};
+	}
+
+	FMemoryReader Reader(Bytes);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	int32 Num = 0;
+	Reader << Magic;
+	Reader << Version;
+	Reader << Num;
+
+	if (Reader.IsError() ||
+		Magic != PropertyHistoryRevisionStore::Magic ||
+		Version != PropertyHistoryRevisionStore::Version ||
+		Num < 0)
+	{
+		return {};
+	}
+
+	TArray<TSharedRef<FPropertyHistoryStoredRevision>> Revisions;
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		const TSharedRef<FPropertyHistoryStoredRevision> Revision = MakeShared<FPropertyHistoryStoredRevision>();
+		Reader << *Revision;
+
+		if (Reader.IsError())
+		{
+			return {};
+		}
+
+		Revisions.Add(Revision);
+	}
+
+	return Revisions;
+}
+
+void FPropertyHistoryRevisionStore::SaveFile(const FString& Path, const TArray<TSharedRef<ISourceControlRevision>>& Revisions)
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+
+	uint32 Magic = PropertyHistoryRevisionStore::Magic;
+	int32 Version = PropertyHistoryRevisionStore::Version;
+	int32 Num = Revisions.Num();
+	Writer << Magic;
+	Writer << Version;
+	Writer << Num;
+
+	for (const TSharedRef<ISourceControlRevision>& Revision : Revisions)
+	{
+		FPropertyHistoryStoredRevision StoredRevision(*Revision);
+		Writer << StoredRevision;
+	}
+
+	FFileHelper::SaveArrayToFile(Bytes, *Path);
+}
+
+FString FPropertyHistoryRevisionStore::GetPath(const FString& PackageFilename)
+{
+	return FPaths::ProjectSavedDir() / "PropertyHistory" / "History" / FMD5::HashAnsiString(*FPaths::ConvertRelativePathToFull(PackageFilename)) + ".bin";
+}
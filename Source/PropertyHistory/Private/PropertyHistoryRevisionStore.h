@@ -0,0 +1,64 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ISourceControlRevision.h"
+
+// Revision metadata restored from the local store
+// It can't fetch anything by itself: its content is either in the revision cache,
+// or it is replaced by the provider revision once the source control history is up to date
+class FPropertyHistoryStoredRevision : public ISourceControlRevision
+{
+public:
+	FString Filename;
+	FString Revision;
+	FString Description;
+	FString UserName;
+	FString ClientSpec;
+	FString Action;
+	FDateTime Date;
+	int32 RevisionNumber = 0;
+	int32 CheckInIdentifier = 0;
+	int32 FileSize = 0;
+	// Revision this file was moved or branched from
+	TSharedPtr<FPropertyHistoryStoredRevision> BranchSource;
+
+	FPropertyHistoryStoredRevision() = default;
+	explicit FPropertyHistoryStoredRevision(const ISourceControlRevision& Other);
+
+	friend FArchive& operator<<(FArchive& Ar, FPropertyHistoryStoredRevision& StoredRevision);
+
+public:
+	//~ Begin ISourceControlRevision Interface
+	virtual bool Get(FString& InOutFilename, EConcurrency::Type InConcurrency = EConcurrency::Synchronous) const override;
+	virtual bool GetAnnotated(TArray<FAnnotationLine>& OutLines) const override;
+	virtual bool GetAnnotated(FString& InOutFilename) const override;
+	virtual const FString& GetFilename() const override;
+	virtual int32 GetRevisionNumber() const override;
+	virtual const FString& GetRevision() const override;
+	virtual const FString& GetDescription() const override;
+	virtual const FString& GetUserName() const override;
+	virtual const FString& GetClientSpec() const override;
+	virtual const FString& GetAction() const override;
+	virtual TSharedPtr<ISourceControlRevision> GetBranchSource() const override;
+	virtual const FDateTime& GetDate() const override;
+	virtual int32 GetCheckInIdentifier() const override;
+	virtual int32 GetFileSize() const override;
+	//~ End ISourceControlRevision Interface
+};
+
+// Committed revisions never change: their metadata is persisted per file in Saved/PropertyHistory/History,
+// so that the history of files we already looked at can be shown before source control answers
+struct FPropertyHistoryRevisionStore
+{
+	// Newest revision first, same order as ISourceControlState::GetHistoryItem
+	static TArray<TSharedRef<FPropertyHistoryStoredRevision>> Load(const FString& PackageFilename);
+	static void Save(const FString& PackageFilename, const TArray<TSharedRef<ISourceControlRevision>>& Revisions);
+
+	static TArray<TSharedRef<FPropertyHistoryStoredRevision>> LoadFile(const FString& Path);
+	static void SaveFile(const FString& Path, const TArray<TSharedRef<ISourceControlRevision>>& Revisions);
+
+private:
+	static FString GetPath(const FString& PackageFilename);
+};
@@ -0,0 +1,318 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistoryScheduler.h"
+#include "ShaderCompiler.h"
+#include "PropertyHistoryUtilities.h"
+
+static TAutoConsoleVariable<int32> CVarPropertyHistoryMaxConcurrentQueries(
+	TEXT("PropertyHistory.MaxConcurrentQueries"),
+	2,
+	TEXT("Max number of source control history queries running at once. Fewer run when source control gets slower"));
+
+static TAutoConsoleVariable<int32> CVarPropertyHistoryMaxConcurrentFetches(
+	TEXT("PropertyHistory.MaxConcurrentFetches"),
+	4,
+	TEXT("Max number of revisions downloaded at once. Fewer run when downloads get slower"));
+
+static TAutoConsoleVariable<float> CVarPropertyHistoryMaxDiskMegabytesPerSecond(
+	TEXT("PropertyHistory.MaxDiskMegabytesPerSecond"),
+	64.f,
+	TEXT("Max disk bandwidth used by revision downloads and revision cache reads. 0 to disable"));
+
+static TAutoConsoleVariable<float> CVarPropertyHistoryBackoffMs(
+	TEXT("PropertyHistory.BackoffMs"),
+	100.f,
+	TEXT("Time between scheduler ticks while no pending work can start, eg while the editor is busy or the disk budget is used up"));
+
+static TAutoConsoleVariable<float> CVarPropertyHistoryLoadBudgetMs(
+	TEXT("PropertyHistory.LoadBudgetMs"),
+	8.f,
+	TEXT("Game thread time spent loading revisions each frame. At least one revision is loaded per frame"));
+
+FPropertyHistoryScheduler& FPropertyHistoryScheduler::Get()
+{
+	static FPropertyHistoryScheduler Scheduler;
+	return Scheduler;
+}
+
+void FPropertyHistoryScheduler::Request(
+	const EPropertyHistoryStage Stage,
+	TFunction<EPropertyHistoryPriority()> GetPriority,
+	const TSharedRef<FThreadSafeBool>& CancellationToken,
+	TFunction<void(const FPropertyHistoryTask&)> Start)
+{
+	check(IsInGameThread());
+
+	Stages[int32(Stage)].Requests.Add(FRequest
+	{
+		MoveTemp(GetPriority),
+		CancellationToken,
+		MoveTemp(Start)
+	});
+
+	// Never start from within Request: callers request their next step from within the previous one
+	WakeUp();
+}
+
+void FPropertyHistoryScheduler::Finish(const FPropertyHistoryTask& Task, const int64 NumBytes)
+{
+	check(IsInGameThread());
+
+	FStage& State = Stages[int32(Task.Stage)];
+	if (!ensure(State.NumRunning > 0))
+	{
+		return;
+	}
+	State.NumRunning--;
+
+	DiskBudget -= NumBytes;
+
+	UpdateConcurrency(Task.Stage, FPlatformTime::Seconds() - Task.StartTime);
+
+	// A slot was freed
+	if (TickerHandle.IsValid())
+	{
+		WakeUp();
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FPropertyHistoryScheduler::WakeUp()
+{
+	if (bTicking)
+	{
+		// Tick decides how to tick next once done
+		return;
+	}
+
+	if (TickerHandle.IsValid())
+	{
+		if (!bBackingOff)
+		{
+			return;
+		}
+
+		FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	}
+
+	bBackingOff = false;
+	AddTicker();
+}
+
+void FPropertyHistoryScheduler::AddTicker()
+{
+	const float Delay = bBackingOff ? CVarPropertyHistoryBackoffMs.GetValueOnGameThread() / 1000.f : 0.f;
+
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(MakeLambdaDelegate([this](float)
+	{
+		return Tick();
+	}), Delay);
+}
+
+bool FPropertyHistoryScheduler::Tick()
+{
+	check(IsInGameThread());
+
+	TGuardValue<bool> TickingGuard(bTicking, true);
+
+	const double Now = FPlatformTime::Seconds();
+	const double DeltaTime = LastTickTime == 0. ? 0. : Now - LastTickTime;
+	LastTickTime = Now;
+
+	const double MaxBytesPerSecond = CVarPropertyHistoryMaxDiskMegabytesPerSecond.GetValueOnGameThread() * 1024. * 1024.;
+	if (MaxBytesPerSecond > 0.)
+	{
+		// Never bank more than a second worth of reads
+		DiskBudget = FMath::Min(DiskBudget + DeltaTime * MaxBytesPerSecond, MaxBytesPerSecond);
+	}
+	else
+	{
+		DiskBudget = MAX_dbl;
+	}
+
+	// Shader compilation & asset loading matter more than any history the user is not looking at
+	const bool bEditorBusy =
+		IsAsyncLoading() ||
+		(GShaderCompilingManager && GShaderCompilingManager->IsCompiling());
+
+	int32 NumStarted = 0;
+
+	for (const EPropertyHistoryStage Stage : { EPropertyHistoryStage::Query, EPropertyHistoryStage::Fetch })
+	{
+		const FStage& State = Stages[int32(Stage)];
+		const int32 MaxRunning = bEditorBusy ? 1 : FMath::FloorToInt(State.Concurrency);
+
+		NumStarted += StartRequests(Stage, MaxRunning, bEditorBusy);
+	}
+
+	// Loads run right away, keep starting them until the frame budget is used up
+	{
+		FStage& State = Stages[int32(EPropertyHistoryStage::Load)];
+
+		const double StartTime = FPlatformTime::Seconds();
+		const double Budget = CVarPropertyHistoryLoadBudgetMs.GetValueOnGameThread() / 1000.;
+
+		for (int32 NumLoadsStarted = 0; ; NumLoadsStarted++)
+		{
+			// Same cap as the other stages while the editor is busy: one load at a time, at most one per frame
+			if (bEditorBusy &&
+				(NumLoadsStarted > 0 || State.NumRunning > 0))
+			{
+				break;
+			}
+
+			// Always make progress, even if a single load is over budget
+			if (NumLoadsStarted > 0 &&
+				FPlatformTime::Seconds() - StartTime + State.AverageLatency > Budget)
+			{
+				break;
+			}
+
+			const int32 Index = FindNextRequest(State, bEditorBusy);
+			if (Index == INDEX_NONE)
+			{
+				break;
+			}
+
+			const FRequest Request = MoveTemp(State.Requests[Index]);
+			State.Requests.RemoveAt(Index);
+
+			State.NumRunning++;
+			Request.Start(FPropertyHistoryTask{ EPropertyHistoryStage::Load, FPlatformTime::Seconds() });
+			NumStarted++;
+		}
+	}
+
+	const bool bHasRequests = INLINE_LAMBDA
+	{
+		for (const FStage& State : Stages)
+		{
+			if (State.Requests.Num() > 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+
+	if (!bHasRequests)
+	{
+		TickerHandle.Reset();
+		bBackingOff = false;
+		return false;
+	}
+
+	// Blocked requests would otherwise have their priority evaluated every frame
+	const bool bShouldBackOff = NumStarted == 0;
+	if (bShouldBackOff == bBackingOff)
+	{
+		return true;
+	}
+
+	// Replaced by a ticker with the right delay
+	bBackingOff = bShouldBackOff;
+	AddTicker();
+	return false;
+}
+
+int32 FPropertyHistoryScheduler::StartRequests(const EPropertyHistoryStage Stage, const int32 MaxRunning, const bool bOnlyVisible)
+{
+	FStage& State = Stages[int32(Stage)];
+
+	int32 NumStarted = 0;
+	while (State.NumRunning < MaxRunning)
+	{
+		if (Stage == EPropertyHistoryStage::Fetch &&
+			DiskBudget <= 0.)
+		{
+			break;
+		}
+
+		const int32 Index = FindNextRequest(State, bOnlyVisible);
+		if (Index == INDEX_NONE)
+		{
+			break;
+		}
+
+		// Start might request more work
+		const FRequest Request = MoveTemp(State.Requests[Index]);
+		State.Requests.RemoveAt(Index);
+
+		State.NumRunning++;
+		Request.Start(FPropertyHistoryTask{ Stage, FPlatformTime::Seconds() });
+		NumStarted++;
+	}
+	return NumStarted;
+}
+
+void FPropertyHistoryScheduler::UpdateConcurrency(const EPropertyHistoryStage Stage, const double Latency)
+{
+	FStage& State = Stages[int32(Stage)];
+
+	State.AverageLatency = State.AverageLatency == 0. ? Latency : FMath::Lerp(State.AverageLatency, Latency, 0.2);
+
+	// Baseline follows the fastest latencies quickly and the slower ones slowly, eg after a network change
+	State.BaselineLatency = State.BaselineLatency == 0. || Latency < State.BaselineLatency
+		? Latency
+		: FMath::Lerp(State.BaselineLatency, Latency, 0.01);
+
+	if (Stage == EPropertyHistoryStage::Load)
+	{
+		// Loads are time sliced instead
+		return;
+	}
+
+	// Additive increase while latencies hold, multiplicative decrease once work starts queuing up on the other side
+	if (State.AverageLatency > 2. * State.BaselineLatency)
+	{
+		State.Concurrency = FMath::Max(1., State.Concurrency * 0.75);
+	}
+	else
+	{
+		State.Concurrency = FMath::Min(double(GetMaxConcurrency(Stage)), State.Concurrency + 1. / State.Concurrency);
+	}
+}
+
+int32 FPropertyHistoryScheduler::GetMaxConcurrency(const EPropertyHistoryStage Stage) const
+{
+	switch (Stage)
+	{
+	case EPropertyHistoryStage::Query: return FMath::Max(1, CVarPropertyHistoryMaxConcurrentQueries.GetValueOnGameThread());
+	case EPropertyHistoryStage::Fetch: return FMath::Max(1, CVarPropertyHistoryMaxConcurrentFetches.GetValueOnGameThread());
+	default: return 1;
+	}
+}
+
+int32 FPropertyHistoryScheduler::FindNextRequest(FStage& State, const bool bOnlyVisible)
+{
+	int32 BestIndex = INDEX_NONE;
+	EPropertyHistoryPriority BestPriority = EPropertyHistoryPriority::Num;
+
+	for (int32 Index = 0; Index < State.Requests.Num(); Index++)
+	{
+		if (*State.Requests[Index].CancellationToken)
+		{
+			State.Requests.RemoveAt(Index);
+			Index--;
+			continue;
+		}
+
+		// Oldest request wins within a priority
+		const EPropertyHistoryPriority Priority = State.Requests[Index].GetPriority();
+		if (Priority < BestPriority)
+		{
+			BestIndex = Index;
+			BestPriority = Priority;
+		}
+	}
+
+	if (bOnlyVisible &&
+		BestPriority != EPropertyHistoryPriority::Visible)
+	{
+		return INDEX_NONE;
+	}
+	return BestIndex;
+}
@@ -0,0 +1,98 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+// Most important first
+enum class EPropertyHistoryPriority : uint8
+{
+	// History shown in a tab
+	Visible,
+	// Histories subscribed to but not shown, eg a selection history
+	Background,
+	// Last changed annotations of details panels
+	Indexing,
+	Num
+};
+
+enum class EPropertyHistoryStage : uint8
+{
+	// Source control history query, asynchronous on the provider
+	Query,
+	// Revision download or revision cache read, on a worker thread
+	Fetch,
+	// Package load or hashing, on the game thread
+	Load,
+	Num
+};
+
+// Given to started work, must be passed back to Finish exactly once
+struct FPropertyHistoryTask
+{
+	EPropertyHistoryStage Stage = {};
+	double StartTime = 0.;
+};
+
+// Owns all the property history work: work is requested per stage, and started once that stage has room for it
+// Query & fetch concurrency adapts to their measured latencies, disk reads are throttled and loads are time sliced,
+// so that history work never starves the editor. Only visible work runs while shaders compile or assets load
+class FPropertyHistoryScheduler
+{
+public:
+	static FPropertyHistoryScheduler& Get();
+
+	// Start is called on the game thread on a later frame, most important requests first
+	// Requests whose token is cancelled before they start are dropped
+	void Request(
+		EPropertyHistoryStage Stage,
+		TFunction<EPropertyHistoryPriority()> GetPriority,
+		const TSharedRef<FThreadSafeBool>& CancellationToken,
+		TFunction<void(const FPropertyHistoryTask&)> Start);
+
+	// Must be called on the game thread. NumBytes is how much the work read from disk
+	void Finish(const FPropertyHistoryTask& Task, int64 NumBytes = 0);
+
+private:
+	struct FRequest
+	{
+		TFunction<EPropertyHistoryPriority()> GetPriority;
+		TSharedPtr<FThreadSafeBool> CancellationToken;
+		TFunction<void(const FPropertyHistoryTask&)> Start;
+	};
+	struct FStage
+	{
+		// Oldest first
+		TArray<FRequest> Requests;
+		int32 NumRunning = 0;
+
+		// Between 1 and the stage max
+		double Concurrency = 1.;
+		// In seconds, zero until measured
+		double AverageLatency = 0.;
+		double BaselineLatency = 0.;
+	};
+	FStage Stages[int32(EPropertyHistoryStage::Num)];
+
+	// Bytes that can still be read this second, negative once over budget
+	double DiskBudget = 0.;
+	double LastTickTime = 0.;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+	bool bTicking = false;
+	// Set once a tick could not start anything: ticks are spaced out until work finishes or is requested
+	bool bBackingOff = false;
+
+	// Ticks next frame, unless already ticking every frame
+	void WakeUp();
+	void AddTicker();
+	bool Tick();
+	// Returns the number of requests started
+	int32 StartRequests(EPropertyHistoryStage Stage, int32 MaxRunning, bool bOnlyVisible);
+	void UpdateConcurrency(EPropertyHistoryStage Stage, double Latency);
+	int32 GetMaxConcurrency(EPropertyHistoryStage Stage) const;
+
+	// Index of the most important request that is not cancelled, INDEX_NONE if none
+	static int32 FindNextRequest(FStage& State, bool bOnlyVisible);
+};
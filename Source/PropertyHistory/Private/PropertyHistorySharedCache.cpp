@@ -0,0 +1,294 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "PropertyHistorySharedCache.h"
+#include "PropertyHistoryHashTree.h"
+#include "PropertyHistoryRevisionData.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "ISourceControlRevision.h"
+
+namespace PropertyHistorySharedCache
+{
+	constexpr uint32 Magic = 0x50485343;
+	// Bump whenever hash trees are built differently
+	constexpr int32 Version = 2;
+}
+
+FString FPropertyHistorySharedCache::GetDirectory()
+{
+	check(IsInGameThread());
+
+	FString Directory;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("PropertyHistorySharedCache="), Directory))
+	{
+		// Project ini: the whole team uses the same directory
+		GConfig->GetString(TEXT("PropertyHistory"), TEXT("SharedCacheDirectory"), Directory, GEditorIni);
+	}
+
+	if (Directory.IsEmpty())
+	{
+		return {};
+	}
+
+	if (FPaths::IsRelative(Directory))
+	{
+		Directory = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), Directory);
+	}
+	return Directory;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FString FPropertyHistorySharedCache::FindContentHash(const FString& Directory, const FString& PackageFilename, const ISourceControlRevision& Revision)
+{
+	if (Directory.IsEmpty())
+	{
+		return {};
+	}
+
+	FString ContentHash;
+	if (!FFileHelper::LoadFileToString(ContentHash, *(Directory / "Revisions" / GetRevisionKey(PackageFilename, Revision)), FFileHelper::EHashOptions::None, FILEREAD_Silent) ||
+		ContentHash.Len() != 40)
+	{
+		return {};
+	}
+
+	return ContentHash;
+}
+
+TSharedPtr<FPropertyHistoryRevisionData> FPropertyHistorySharedCache::FindRevision(
+	const FString& Directory,
+	const FString& PackageFilename,
+	const ISourceControlRevision& Revision,
+	const FString& LocalCachePath)
+{
+	const FString ContentHash = FindContentHash(Directory, PackageFilename, Revision);
+	if (ContentHash.IsEmpty())
+	{
+		return nullptr;
+	}
+
+	const FString BlobPath = Directory / "Blobs" / ContentHash + FPaths::GetExtension(PackageFilename, true);
+	if (!IFileManager::Get().FileExists(*BlobPath))
+	{
+		return nullptr;
+	}
+
+	TSharedPtr<FPropertyHistoryRevisionData> Data;
+	if (!LocalCachePath.IsEmpty())
+	{
+		IFileManager::Get().MakeDirectory(*FPaths::GetPath(LocalCachePath), true);
+
+		// Copied under a temp name first, like any other cache write
+		const FString TempPath = LocalCachePath + "." + FGuid::NewGuid().ToString() + ".tmp";
+		if (IFileManager::Get().Copy(*TempPath, *BlobPath) == COPY_OK)
+		{
+			IFileManager::Get().Move(*LocalCachePath, *TempPath, false, false, false, true);
+			IFileManager::Get().Delete(*TempPath, false, false, true);
+			Data = FPropertyHistoryRevisionData::MapFile(LocalCachePath);
+		}
+	}
+
+	if (!Data)
+	{
+		Data = FPropertyHistoryRevisionData::LoadFile(BlobPath);
+	}
+
+	if (Data)
+	{
+		Data->ContentHash = ContentHash;
+	}
+	return Data;
+}
+
+FString FPropertyHistorySharedCache::AddRevision(
+	const FString& Directory,
+	const FString& PackageFilename,
+	const ISourceControlRevision& Revision,
+	const TConstArrayView64<uint8> Bytes)
+{
+	if (Directory.IsEmpty())
+	{
+		return {};
+	}
+
+	FSHAHash Hash;
+	FSHA1::HashBuffer(Bytes.GetData(), Bytes.Num(), Hash.Hash);
+	const FString ContentHash = Hash.ToString();
+
+	// Blob first: a revision is never pointing to a missing blob
+	if (!WriteFile(Directory / "Blobs" / ContentHash + FPaths::GetExtension(PackageFilename, true), Bytes))
+	{
+		return {};
+	}
+
+	const FTCHARToUTF8 ContentHashUtf8(*ContentHash);
+	if (!WriteFile(
+		Directory / "Revisions" / GetRevisionKey(PackageFilename, Revision),
+		TConstArrayView64<uint8>(reinterpret_cast<const uint8*>(ContentHashUtf8.Get()), ContentHashUtf8.Length())))
+	{
+		return {};
+	}
+
+	return ContentHash;
+}
+
+FString FPropertyHistorySharedCache::FindOrAddRevision(
+	const FString& Directory,
+	const FString& PackageFilename,
+	const ISourceControlRevision& Revision,
+	const TConstArrayView64<uint8> Bytes)
+{
+	const FString ContentHash = FindContentHash(Directory, PackageFilename, Revision);
+	if (!ContentHash.IsEmpty())
+	{
+		return ContentHash;
+	}
+
+	return AddRevision(Directory, PackageFilename, Revision, Bytes);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FString FPropertyHistorySharedCache::GetValueKey(const FString& ObjectPathName, const FName PropertyName)
+{
+	// Object paths start with their package name, which is the same on every machine
+	return FMD5::HashAnsiString(*(ObjectPathName + ":" + PropertyName.ToString()));
+}
+
+TOptional<TSharedPtr<const FPropertyHistoryHashNode>> FPropertyHistorySharedCache::FindHashTree(const FString& Directory, const FString& ContentHash, const FString& ValueKey)
+{
+	if (Directory.IsEmpty())
+	{
+		return {};
+	}
+
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *(Directory / "Indexes" / ContentHash / ValueKey), FILEREAD_Silent))
+	{
+		return {};
+	}
+
+	FMemoryReader Reader(Bytes);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	bool bExists = false;
+	Reader << Magic;
+	Reader << Version;
+	Reader << bExists;
+
+	if (Reader.IsError() ||
+		Magic != PropertyHistorySharedCache::Magic ||
+		Version != PropertyHistorySharedCache::Version)
+	{
+		return {};
+	}
+
+	if (!bExists)
+	{
+		return TSharedPtr<const FPropertyHistoryHashNode>();
+	}
+
+	const TSharedRef<FPropertyHistoryHashNode> HashTree = MakeShared<FPropertyHistoryHashNode>();
+	Reader << *HashTree;
+
+	if (Reader.IsError())
+	{
+		return {};
+	}
+
+	return TSharedPtr<const FPropertyHistoryHashNode>(HashTree);
+}
+
+void FPropertyHistorySharedCache::AddHashTree(const FString& Directory, const FString& ContentHash, const FString& ValueKey, const FPropertyHistoryHashNode* HashTree)
+{
+	if (Directory.IsEmpty())
+	{
+		return;
+	}
+
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+
+	uint32 Magic = PropertyHistorySharedCache::Magic;
+	int32 Version = PropertyHistorySharedCache::Version;
+	bool bExists = HashTree != nullptr;
+	Writer << Magic;
+	Writer << Version;
+	Writer << bExists;
+
+	if (HashTree)
+	{
+		FPropertyHistoryHashNode Copy = *HashTree;
+		Writer << Copy;
+	}
+
+	WriteFile(Directory / "Indexes" / ContentHash / ValueKey, Bytes);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FString FPropertyHistorySharedCache::GetRevisionKey(const FString& PackageFilename, const ISourceControlRevision& Revision)
+{
+	FString Filename = Revision.GetFilename();
+	if (Filename.IsEmpty())
+	{
+		Filename = PackageFilename;
+	}
+
+	// Perforce depot paths tell branches & streams apart, its revision numbers are per file
+	if (!Filename.StartsWith(TEXT("//")))
+	{
+		Filename = FPaths::ConvertRelativePathToFull(Filename);
+		FPaths::MakePathRelativeTo(Filename, *FPaths::ConvertRelativePathToFull(FPaths::ProjectDir()));
+	}
+
+	return FMD5::HashAnsiString(*(Filename + "@" + Revision.GetRevision()));
+}
+
+bool FPropertyHistorySharedCache::WriteFile(const FString& Path, const TConstArrayView64<uint8> Bytes)
+{
+	IFileManager& FileManager = IFileManager::Get();
+
+	// Entries never change: whoever wrote it first wrote the same bytes
+	if (FileManager.FileExists(*Path))
+	{
+		return true;
+	}
+
+	// Unique per writer, so that editors writing the same entry at the same time never write to the same file
+	const FString TempPath = Path + "." + FGuid::NewGuid().ToString() + ".tmp";
+	{
+		const TUniquePtr<FArchive> Writer(FileManager.CreateFileWriter(*TempPath, FILEWRITE_Silent));
+		if (!Writer)
+		{
+			return false;
+		}
+
+		Writer->Serialize(const_cast<uint8*>(Bytes.GetData()), Bytes.Num());
+
+		if (!Writer->Close())
+		{
+			FileManager.Delete(*TempPath, false, false, true);
+			return false;
+		}
+	}
+
+	// Renames are atomic on the same volume: readers either see the whole file or nothing
+	if (!FileManager.Move(*Path, *TempPath, false, false, false, true))
+	{
+		FileManager.Delete(*TempPath, false, false, true);
+
+		// Another writer won the race
+		return FileManager.FileExists(*Path);
+	}
+
+	return true;
+}
@@ -0,0 +1,58 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ISourceControlRevision;
+class FPropertyHistoryRevisionData;
+struct FPropertyHistoryHashNode;
+
+// Optional cache shared by a whole team, eg on a network share, so that each revision is only fetched & hashed once per team
+// Configured through [PropertyHistory] SharedCacheDirectory in the project editor ini or -PropertyHistorySharedCache=,
+// and pre-populated by the PropertyHistory commandlet, eg nightly on a build machine
+// Keys only use depot or project relative paths, so that checkouts at different locations share entries:
+// - Blobs/<content hash>.uasset: revision bytes, revisions with the same content are only stored once
+// - Revisions/<revision key>: content hash of a revision
+// - Indexes/<content hash>/<value key>: hash tree of a property of an object in that revision, as used by the change index
+// Entries never change once written, and are written under a unique temp name then renamed: readers never see partial files
+struct FPropertyHistorySharedCache
+{
+	// Empty if disabled. Must be called on the game thread
+	static FString GetDirectory();
+
+	// Everything below can be called from any thread, and does nothing if Directory is empty
+
+	// Empty if the revision is not in the cache
+	static FString FindContentHash(const FString& Directory, const FString& PackageFilename, const ISourceControlRevision& Revision);
+	// Null if the revision is not in the cache
+	// Copied to LocalCachePath if set, so that it is only read once over the network
+	static TSharedPtr<FPropertyHistoryRevisionData> FindRevision(
+		const FString& Directory,
+		const FString& PackageFilename,
+		const ISourceControlRevision& Revision,
+		const FString& LocalCachePath);
+	// Returns the content hash, empty on failure
+	static FString AddRevision(
+		const FString& Directory,
+		const FString& PackageFilename,
+		const ISourceControlRevision& Revision,
+		TConstArrayView64<uint8> Bytes);
+	// Same as AddRevision, without writing anything if the revision is already in the cache
+	static FString FindOrAddRevision(
+		const FString& Directory,
+		const FString& PackageFilename,
+		const ISourceControlRevision& Revision,
+		TConstArrayView64<uint8> Bytes);
+
+	// Identifies a property of an object the same way on every machine
+	static FString GetValueKey(const FString& ObjectPathName, FName PropertyName);
+	// Unset if not in the cache, null if the property or its object does not exist in that revision
+	static TOptional<TSharedPtr<const FPropertyHistoryHashNode>> FindHashTree(const FString& Directory, const FString& ContentHash, const FString& ValueKey);
+	static void AddHashTree(const FString& Directory, const FString& ContentHash, const FString& ValueKey, const FPropertyHistoryHashNode* HashTree);
+
+private:
+	// Revision names are not unique on their own, eg Perforce numbers revisions per file and branch
+	static FString GetRevisionKey(const FString& PackageFilename, const ISourceControlRevision& Revision);
+	static bool WriteFile(const FString& Path, TConstArrayView64<uint8> Bytes);
+};
@@ -6,11 +6,74 @@
 #include "IPropertyRowGenerator.h"
 #include "ISourceControlRevision.h"
 #include "PropertyHistoryUtilities.h"
+#include "SPropertyHistoryGraph.h"
 #include "Widgets/Images/SThrobber.h"
 #include "Widgets/Layout/SScaleBox.h"
+#include "Widgets/Input/SSearchBox.h"
+#include "Widgets/Layout/SSplitter.h"
 #include "Framework/Commands/GenericCommands.h"
 #include "InstancedPropertyBagStructureDataProvider.h"
 
+TSharedPtr<SWidget> FPropertyHistoryValueWidgetCache::FindUnused(const FPropertyHistoryEntry& Entry) const
+{
+	// Rows scrolled out of view are destroyed, leaving their widgets without parent
+	if (!Entry.ValueWidget ||
+		Entry.ValueWidget->GetParentWidget())
+	{
+		return nullptr;
+	}
+
+	return Entry.ValueWidget;
+}
+
+void FPropertyHistoryValueWidgetCache::Add(const TSharedPtr<FPropertyHistoryEntry>& Entry, const TSharedRef<SWidget>& Widget)
+{
+	Entry->ValueWidget = Widget;
+
+	// Entries whose widget is replaced move to the back, destroyed entries are dropped
+	Entries.RemoveAll([&](const TWeakPtr<FPropertyHistoryEntry>& WeakEntry)
+	{
+		return
+			!WeakEntry.IsValid() ||
+			WeakEntry.HasSameObject(Entry.Get());
+	});
+	Entries.Add(Entry);
+
+	if (Entries.Num() <= MaxNum)
+	{
+		return;
+	}
+
+	// Released widgets might still be used by their row, they are only freed once it is gone
+	const int32 NumToRelease = Entries.Num() - MaxNum;
+	for (int32 Index = 0; Index < NumToRelease; Index++)
+	{
+		const TSharedPtr<FPropertyHistoryEntry> OldEntry = Entries[Index].Pin();
+		if (OldEntry &&
+			OldEntry != Entry)
+		{
+			OldEntry->ValueWidget.Reset();
+		}
+	}
+	Entries.RemoveAt(0, NumToRelease);
+}
+
+void FPropertyHistoryValueWidgetCache::Reset()
+{
+	for (const TWeakPtr<FPropertyHistoryEntry>& WeakEntry : Entries)
+	{
+		if (const TSharedPtr<FPropertyHistoryEntry> Entry = WeakEntry.Pin())
+		{
+			Entry->ValueWidget.Reset();
+		}
+	}
+	Entries.Reset();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
 void SPropertyHistory::Construct(const FArguments& Args)
 {
 	ColumnSizeData = MakeShared<FDetailColumnSizeData>();
@@ -27,234 +90,358 @@ void SPropertyHistory::Construct(const FArguments& Args)
 
 	ChildSlot
 	[
-		SNew(SOverlay)
-		+ SOverlay::Slot()
+		SNew(SVerticalBox)
+		+ SVerticalBox::Slot()
+		.AutoHeight()
+		.Padding(0.f, 0.f, 0.f, 2.f)
 		[
-			SAssignNew(ListView, STreeView<TSharedPtr<FPropertyHistoryEntry>>)
-			.IsEnabled_Lambda([this]
-			{
-				if (!PrivateHandler ||
-					PrivateHandler->IsLoading())
-				{
-					return false;
-				}
-
-				return true;
-			})
-			.SelectionMode(ESelectionMode::Single)
-			.TreeItemsSource(&Entries)
-			.OnGetChildren_Lambda([](const TSharedPtr<FPropertyHistoryEntry>& Item, TArray<TSharedPtr<FPropertyHistoryEntry>>& OutChildren)
+			SAssignNew(SearchBox, SSearchBox)
+			.HintText(INVTEXT("Filter: words, author:Name, after:2024-01-01, before:2024-01-01, value>100, value==T_Foo"))
+			.OnTextChanged_Lambda([this](const FText& Text)
 			{
-				OutChildren = Item->Children;
+				FilterText = Text.ToString();
+				ApplyFilter();
 			})
-			.OnMouseButtonDoubleClick_Lambda([this](const TSharedPtr<FPropertyHistoryEntry>&)
-			{
-				if (!PrivateHandler)
-				{
-					return;
-				}
+		]
+		+ SVerticalBox::Slot()
+		.FillHeight(1.f)
+		[
+			SNew(SOverlay)
+			+ SOverlay::Slot()
+			[
+				SNew(SSplitter)
+				+ SSplitter::Slot()
+				.Value(0.7f)
+				[
+					SAssignNew(ListView, STreeView<TSharedPtr<FPropertyHistoryEntry>>)
+					.IsEnabled(false)
+					.SelectionMode(ESelectionMode::Single)
+					.TreeItemsSource(&Entries)
+					.OnGetChildren_Lambda([](const TSharedPtr<FPropertyHistoryEntry>& Item, TArray<TSharedPtr<FPropertyHistoryEntry>>& OutChildren)
+					{
+						OutChildren = Item->Children;
+					})
+					.OnSelectionChanged_Lambda([this](const TSharedPtr<FPropertyHistoryEntry>& Entry, ESelectInfo::Type)
+					{
+						Graph->SetSelectedEntry(Entry);
+					})
+					.OnMouseButtonDoubleClick_Lambda([this](const TSharedPtr<FPropertyHistoryEntry>&)
+					{
+						if (!PrivateHandler)
+						{
+							return;
+						}
 
-				PrivateHandler->ShowFullHistory();
-			})
-			.OnContextMenuOpening_Lambda([this]() -> TSharedRef<SWidget>
-			{
-				const TArray<TSharedPtr<FPropertyHistoryEntry>>& SelectedItems = ListView->GetSelectedItems();
-				if (SelectedItems.Num() != 1)
-				{
-					return SNullWidget::NullWidget;
-				}
+						PrivateHandler->ShowFullHistory();
+					})
+					.OnContextMenuOpening_Lambda([this]() -> TSharedRef<SWidget>
+					{
+						const TArray<TSharedPtr<FPropertyHistoryEntry>>& SelectedItems = ListView->GetSelectedItems();
+						if (SelectedItems.Num() != 1)
+						{
+							return SNullWidget::NullWidget;
+						}
 
-				const TSharedPtr<FPropertyHistoryEntry>& SelectedItem = SelectedItems[0];
-				if (!SelectedItem->Handle)
-				{
-					return SNullWidget::NullWidget;
-				}
+						const TSharedPtr<FPropertyHistoryEntry>& SelectedItem = SelectedItems[0];
+						if (!SelectedItem->Handle)
+						{
+							return SNullWidget::NullWidget;
+						}
 
-				FUIAction CopyAction;
-				FUIAction PasteAction;
-				SelectedItem->Handle->CreateDefaultPropertyCopyPasteActions(CopyAction, PasteAction);
+						FUIAction CopyAction;
+						FUIAction PasteAction;
+						SelectedItem->Handle->CreateDefaultPropertyCopyPasteActions(CopyAction, PasteAction);
 
-				FMenuBuilder MenuBuilder(true, nullptr);
+						FMenuBuilder MenuBuilder(true, nullptr);
 
-				const TSharedPtr<FUICommandInfo> CopyCommand = FGenericCommands::Get().Copy;
+						const TSharedPtr<FUICommandInfo> CopyCommand = FGenericCommands::Get().Copy;
 
-				MenuBuilder.BeginSection("BasicOperations");
-				{
-					MenuBuilder.AddMenuEntry(
-						CopyCommand->GetLabel(),
-						CopyCommand->GetDescription(),
-						CopyCommand->GetIcon(),
-						CopyAction);
-				}
-				MenuBuilder.EndSection();
-
-				return MenuBuilder.MakeWidget();
-			})
-			.HeaderRow(
-				SAssignNew(HeaderRow, SHeaderRow)
-				.CanSelectGeneratedColumn(true)
-				.HiddenColumnsList(HiddenColumnsList)
-				.OnHiddenColumnsListChanged_Lambda([this]
-				{
-					TArray<FString> HiddenColumnStrings;
-					for (const FName ColumnId : HeaderRow->GetHiddenColumnIds())
-					{
-						HiddenColumnStrings.Add(ColumnId.ToString());
-					}
+						MenuBuilder.BeginSection("BasicOperations");
+						{
+							MenuBuilder.AddMenuEntry(
+								CopyCommand->GetLabel(),
+								CopyCommand->GetDescription(),
+								CopyCommand->GetIcon(),
+								CopyAction);
+						}
+						MenuBuilder.EndSection();
 
-					GConfig->SetArray(TEXT("PropertyHistory"), TEXT("HiddenColumns"), HiddenColumnStrings, GEditorPerProjectIni);
-				})
+						return MenuBuilder.MakeWidget();
+					})
+					.HeaderRow(
+						SAssignNew(HeaderRow, SHeaderRow)
+						.CanSelectGeneratedColumn(true)
+						.HiddenColumnsList(HiddenColumnsList)
+						.OnHiddenColumnsListChanged_Lambda([this]
+						{
+							TArray<FString> HiddenColumnStrings;
+							for (const FName ColumnId : HeaderRow->GetHiddenColumnIds())
+							{
+								HiddenColumnStrings.Add(ColumnId.ToString());
+							}
 
-				+ SHeaderRow::Column("Expander")
-				.FixedWidth(20.f)
-				.ShouldGenerateWidget(true)
-				.DefaultLabel(INVTEXT("Expander"))
-				[
-					SNew(SSpacer)
-				]
+							GConfig->SetArray(TEXT("PropertyHistory"), TEXT("HiddenColumns"), HiddenColumnStrings, GEditorPerProjectIni);
+						})
 
-				+ SHeaderRow::Column("CL")
-				.VAlignHeader(VAlign_Center)
-				.FillWidth(1.f)
-				.DefaultLabel(INVTEXT("CL"))
-
-				+ SHeaderRow::Column("Revision")
-				.VAlignHeader(VAlign_Center)
-				.FillWidth(1.5f)
-				.DefaultLabel(INVTEXT("Revision"))
-
-				+ SHeaderRow::Column("Value")
-				.VAlignHeader(VAlign_Center)
-				.FillWidth(5.f)
-				.DefaultLabel(INVTEXT("Value"))
-
-				+ SHeaderRow::Column("Author")
-				.VAlignHeader(VAlign_Center)
-				.HAlignHeader(HAlign_Center)
-				.FillWidth(2.f)
-				.DefaultLabel(INVTEXT("Author"))
-
-				+ SHeaderRow::Column("Description")
-				.VAlignHeader(VAlign_Center)
-				.HAlignHeader(HAlign_Center)
-				.FillWidth(7.f)
-				.DefaultLabel(INVTEXT("Description"))
-
-				+ SHeaderRow::Column("Date")
-				.VAlignHeader(VAlign_Center)
-				.HAlignHeader(HAlign_Center)
-				.FillWidth(2.f)
-				.DefaultLabel(INVTEXT("Date"))
-			)
-			.OnGenerateRow_Lambda([](const TSharedPtr<FPropertyHistoryEntry>& Line, const TSharedRef<STableViewBase>& OwnerTable) -> TSharedRef<STableRow<TSharedPtr<FPropertyHistoryEntry>>>
-			{
-				if (Line->Revision)
-				{
-					return SNew(SPropertyEntry, OwnerTable, Line);
-				}
+						+ SHeaderRow::Column("Expander")
+						.FixedWidth(20.f)
+						.ShouldGenerateWidget(true)
+						.DefaultLabel(INVTEXT("Expander"))
+						[
+							SNew(SSpacer)
+						]
 
-				return SNew(SPropertyEntryValue, OwnerTable, Line);
-			})
-		]
-		+ SOverlay::Slot()
-		.HAlign(HAlign_Center)
-		.VAlign(VAlign_Center)
-		[
-			SNew(SScaleBox)
-			.IgnoreInheritedScale(true)
-			.Visibility_Lambda([this]
-			{
-				return
-					PrivateHandler &&
-					PrivateHandler->IsLoading()
-					? EVisibility::Visible
-					: EVisibility::Collapsed;
-			})
+						+ SHeaderRow::Column("CL")
+						.VAlignHeader(VAlign_Center)
+						.FillWidth(1.f)
+						.DefaultLabel(INVTEXT("CL"))
+
+						+ SHeaderRow::Column("Revision")
+						.VAlignHeader(VAlign_Center)
+						.FillWidth(1.5f)
+						.DefaultLabel(INVTEXT("Revision"))
+
+						+ SHeaderRow::Column("Value")
+						.VAlignHeader(VAlign_Center)
+						.FillWidth(5.f)
+						.DefaultLabel(INVTEXT("Value"))
+
+						+ SHeaderRow::Column("Author")
+						.VAlignHeader(VAlign_Center)
+						.HAlignHeader(HAlign_Center)
+						.FillWidth(2.f)
+						.DefaultLabel(INVTEXT("Author"))
+
+						+ SHeaderRow::Column("Description")
+						.VAlignHeader(VAlign_Center)
+						.HAlignHeader(HAlign_Center)
+						.FillWidth(7.f)
+						.DefaultLabel(INVTEXT("Description"))
+
+						+ SHeaderRow::Column("Date")
+						.VAlignHeader(VAlign_Center)
+						.HAlignHeader(HAlign_Center)
+						.FillWidth(2.f)
+						.DefaultLabel(INVTEXT("Date"))
+					)
+					.OnGenerateRow_Lambda([this](const TSharedPtr<FPropertyHistoryEntry>& Line, const TSharedRef<STableViewBase>& OwnerTable) -> TSharedRef<STableRow<TSharedPtr<FPropertyHistoryEntry>>>
+					{
+						if (Line->Revision)
+						{
+							return SNew(SPropertyEntry, OwnerTable, Line, ValueWidgetCache);
+						}
+
+						return SNew(SPropertyEntryValue, OwnerTable, Line);
+					})
+				]
+				+ SSplitter::Slot()
+				.Value(0.3f)
+				[
+					SAssignNew(GraphPanel, SVerticalBox)
+					.Visibility(EVisibility::Collapsed)
+					+ SVerticalBox::Slot()
+					.AutoHeight()
+					.Padding(4.f, 2.f)
+					[
+						SNew(SCheckBox)
+						.ToolTipText(INVTEXT("Space revisions by date instead of evenly"))
+						.OnCheckStateChanged_Lambda([this](const ECheckBoxState State)
+						{
+							Graph->SetByDate(State == ECheckBoxState::Checked);
+						})
+						[
+							SNew(STextBlock)
+							.Text(INVTEXT("By date"))
+						]
+					]
+					+ SVerticalBox::Slot()
+					.FillHeight(1.f)
+					[
+						SAssignNew(Graph, SPropertyHistoryGraph)
+						.OnEntryClicked_Lambda([this](const TSharedPtr<FPropertyHistoryEntry>& Entry)
+						{
+							ListView->SetSelection(Entry);
+							ListView->RequestScrollIntoView(Entry);
+						})
+					]
+				]
+			]
+			+ SOverlay::Slot()
+			.HAlign(HAlign_Center)
+			.VAlign(VAlign_Center)
 			[
-				SNew(SThrobber)
+				SAssignNew(Throbber, SScaleBox)
+				.IgnoreInheritedScale(true)
+				.Visibility(EVisibility::Collapsed)
+				[
+					SNew(SThrobber)
+				]
+			]
+			+ SOverlay::Slot()
+			.HAlign(HAlign_Center)
+			.VAlign(VAlign_Bottom)
+			[
+				SAssignNew(ErrorText, STextBlock)
+				.ColorAndOpacity(FStyleColors::Error)
+				.Visibility(EVisibility::Collapsed)
 			]
-		]
-		+ SOverlay::Slot()
-		.HAlign(HAlign_Center)
-		.VAlign(VAlign_Bottom)
-		[
-			SNew(STextBlock)
-			.Text_Lambda([this]
-			{
-				if (!PrivateHandler ||
-					!PrivateHandler->GetError().IsSet())
-				{
-					return FText();
-				}
-
-				return FText::FromString(PrivateHandler->GetError().GetValue());
-			})
-			.ColorAndOpacity(FStyleColors::Error)
-			.Visibility_Lambda([this]
-			{
-				return
-					PrivateHandler &&
-					PrivateHandler->GetError().IsSet()
-					? EVisibility::Visible
-					: EVisibility::Collapsed;
-			})
 		]
 	];
 }
 
 void SPropertyHistory::SetHandler(const TSharedPtr<FPropertyHistoryHandler>& Handler)
 {
+	if (PrivateHandler == Handler)
+	{
+		Handler->MakePriority();
+		return;
+	}
+
+	if (PrivateHandler)
+	{
+		// Nobody will see it anymore
+		PrivateHandler->OnNewEntry.RemoveAll(this);
+		PrivateHandler->OnStateChanged.RemoveAll(this);
+		PrivateHandler->Cancel();
+	}
+
 	PrivateHandler = Handler;
+	PrivateHandler->MakePriority();
 
-	Entries.Empty();
-	ListView->RequestTreeRefresh();
+	ValueWidgetCache->Reset();
+
+	// The handler might already have entries if its package was loaded for another property
+	RefreshEntries();
+	RefreshState();
+
+	Handler->OnNewEntry.AddSP(this, &SPropertyHistory::RefreshEntries);
+	Handler->OnStateChanged.AddSP(this, &SPropertyHistory::RefreshState);
+}
+
+void SPropertyHistory::RefreshEntries()
+{
+	const TArray<TSharedPtr<FPropertyHistoryEntry>>& AllEntries = PrivateHandler->Entries;
 
-	Handler->OnNewEntry.AddLambda(MakeWeakPtrLambda(this, [this]
+	for (const TSharedPtr<FPropertyHistoryEntry>& Entry : AllEntries)
 	{
-		Entries = PrivateHandler->Entries;
+		if (!Entry->Node)
+		{
+			InitializeEntry(Entry);
+		}
+	}
 
-		if (Entries.Num() > 0)
+	// Entries are newest first: each one is diffed against the next one, filtered out or not
+	for (int32 Index = 0; Index < AllEntries.Num(); Index++)
+	{
+		const TSharedPtr<FPropertyHistoryEntry> OlderEntry = AllEntries.IsValidIndex(Index + 1) ? AllEntries[Index + 1] : nullptr;
+		if (AllEntries[Index]->DiffedAgainst.Pin() != OlderEntry)
 		{
-			if (const TSharedPtr<FPropertyHistoryEntry> Entry = Entries.Last())
-			{
-				if (!Entry->Node)
-				{
-					InitializeEntry(Entry);
-				}
-			}
+			DiffEntry(AllEntries[Index], OlderEntry);
 		}
+	}
+
+	// Only rebuilt once a filter needs it
+	bEntryIndexDirty = true;
 
-		ListView->RequestTreeRefresh();
-	}));
+	ApplyFilter();
 }
 
-void SPropertyHistory::InitializeEntry(const TSharedPtr<FPropertyHistoryEntry>& Entry) const
+void SPropertyHistory::ApplyFilter()
 {
-	FPropertyEditorModule& PropertyModule = FModuleManager::LoadModuleChecked<FPropertyEditorModule>("PropertyEditor");
-	const TSharedPtr<FInstancePropertyBagStructureDataProvider> StructProvider = MakeShared<FInstancePropertyBagStructureDataProvider>(Entry->Value);
+	if (!PrivateHandler)
+	{
+		return;
+	}
 
-	const TSharedRef<IPropertyRowGenerator> PropertyRowGenerator = PropertyModule.CreatePropertyRowGenerator(FPropertyRowGeneratorArgs());
-	PropertyRowGenerator->SetStructure(StructProvider);
+	const TArray<TSharedPtr<FPropertyHistoryEntry>>& AllEntries = PrivateHandler->Entries;
 
-	Entry->PropertyRowGenerator = PropertyRowGenerator;
-	if (!ensure(PropertyRowGenerator->GetRootTreeNodes().Num() == 1))
+	FString Error;
+	const TOptional<TBitArray<>> Matches = INLINE_LAMBDA -> TOptional<TBitArray<>>
 	{
-		return;
+		if (FilterText.TrimStartAndEnd().IsEmpty())
+		{
+			return {};
+		}
+
+		if (bEntryIndexDirty)
+		{
+			EntryIndex.Build(AllEntries);
+			bEntryIndexDirty = false;
+		}
+
+		return EntryIndex.Filter(FilterText, Error);
+	};
+
+	SearchBox->SetError(FText::FromString(Error));
+
+	if (!Matches)
+	{
+		Entries = AllEntries;
 	}
+	else
+	{
+		Entries.Reset();
+		for (TConstSetBitIterator<> It(*Matches); It; ++It)
+		{
+			Entries.Add(AllEntries[It.GetIndex()]);
+		}
+	}
+
+	ListView->RequestTreeRefresh();
 
-	Entry->Node = PropertyRowGenerator->GetRootTreeNodes()[0];
+	// Only numbers, vectors, colors... can be plotted
+	GraphPanel->SetVisibility(Graph->SetEntries(Entries) ? EVisibility::Visible : EVisibility::Collapsed);
+}
+
+// Pushed by the handler instead of polled from attributes, so that nothing is evaluated while idle
+void SPropertyHistory::RefreshState()
+{
+	const bool bIsLoading = PrivateHandler->IsLoading();
+	const TOptional<FString>& Error = PrivateHandler->GetError();
+
+	ListView->SetEnabled(!bIsLoading);
+	Throbber->SetVisibility(bIsLoading ? EVisibility::Visible : EVisibility::Collapsed);
+
+	ErrorText->SetText(Error.IsSet() ? FText::FromString(Error.GetValue()) : FText());
+	ErrorText->SetVisibility(Error.IsSet() ? EVisibility::Visible : EVisibility::Collapsed);
+}
 
+void SPropertyHistory::InitializeEntry(const TSharedPtr<FPropertyHistoryEntry>& Entry) const
+{
+	FPropertyHistoryValue& Value = *Entry->Value;
+
+	// One row generator per distinct value
+	if (!Value.PropertyRowGenerator)
 	{
+		FPropertyEditorModule& PropertyModule = FModuleManager::LoadModuleChecked<FPropertyEditorModule>("PropertyEditor");
+		const TSharedPtr<FInstancePropertyBagStructureDataProvider> StructProvider = MakeShared<FInstancePropertyBagStructureDataProvider>(Value.Bag);
+
+		const TSharedRef<IPropertyRowGenerator> PropertyRowGenerator = PropertyModule.CreatePropertyRowGenerator(FPropertyRowGeneratorArgs());
+		PropertyRowGenerator->SetStructure(StructProvider);
+
+		Value.PropertyRowGenerator = PropertyRowGenerator;
+		if (!ensure(PropertyRowGenerator->GetRootTreeNodes().Num() == 1))
+		{
+			return;
+		}
+
 		TArray<TSharedRef<IDetailTreeNode>> Children;
-		Entry->Node->GetChildren(Children);
+		PropertyRowGenerator->GetRootTreeNodes()[0]->GetChildren(Children);
 		if (!ensure(Children.Num() == 1))
 		{
 			return;
 		}
 
-		Entry->Node = Children[0];
+		Value.Node = Children[0];
 	}
 
+	if (!Value.Node)
+	{
+		return;
+	}
+
+	Entry->Node = Value.Node;
+
 	const auto FillChildren = [&](const TSharedPtr<FPropertyHistoryEntry>& CurrentEntry, auto& Lambda) -> void
 	{
 		CurrentEntry->ColumnSizeData = ColumnSizeData;
@@ -275,6 +462,88 @@ void SPropertyHistory::InitializeEntry(const TSharedPtr<FPropertyHistoryEntry>&
 	FillChildren(Entry, FillChildren);
 }
 
+void SPropertyHistory::DiffEntry(const TSharedPtr<FPropertyHistoryEntry>& Entry, const TSharedPtr<FPropertyHistoryEntry>& OlderEntry)
+{
+	for (const TWeakPtr<FPropertyHistoryEntry>& WeakChild : Entry->ChangedChildren)
+	{
+		if (const TSharedPtr<FPropertyHistoryEntry> Child = WeakChild.Pin())
+		{
+			Child->bChanged = false;
+		}
+	}
+	Entry->ChangedChildren.Reset();
+	Entry->DiffedAgainst = OlderEntry;
+
+	if (!OlderEntry ||
+		!Entry->Value->HashTree ||
+		!OlderEntry->Value->HashTree)
+	{
+		return;
+	}
+
+	const auto FindNode = [](const FPropertyHistoryHashNode& Parent, const IPropertyHandle& Handle) -> const FPropertyHistoryHashNode*
+	{
+		if (Parent.bIsContainer)
+		{
+			return Parent.FindChild(Handle.GetIndexInArray());
+		}
+
+		const FProperty* Property = Handle.GetProperty();
+		if (!Property)
+		{
+			return nullptr;
+		}
+
+		return Parent.FindChild(Property->GetFName());
+	};
+
+	// Subtrees with the same hash are skipped entirely
+	const auto Diff = [&](
+		const FPropertyHistoryEntry& CurrentEntry,
+		const FPropertyHistoryHashNode& Node,
+		const FPropertyHistoryHashNode& OlderNode,
+		auto& Lambda) -> void
+	{
+		for (const TSharedPtr<FPropertyHistoryEntry>& Child : CurrentEntry.Children)
+		{
+			if (!Child->Handle)
+			{
+				continue;
+			}
+
+			const FPropertyHistoryHashNode* ChildNode = FindNode(Node, *Child->Handle);
+			if (!ChildNode)
+			{
+				// Customized row we can't map back to the value
+				continue;
+			}
+
+			const FPropertyHistoryHashNode* OlderChildNode = FindNode(OlderNode, *Child->Handle);
+			if (OlderChildNode &&
+				OlderChildNode->Hash == ChildNode->Hash)
+			{
+				continue;
+			}
+
+			Child->bChanged = true;
+			Entry->ChangedChildren.Add(Child);
+
+			if (OlderChildNode &&
+				Child->Children.Num() > 0)
+			{
+				ListView->SetItemExpansion(Child, true);
+				Lambda(*Child, *ChildNode, *OlderChildNode, Lambda);
+			}
+		}
+	};
+	Diff(*Entry, *Entry->Value->HashTree, *OlderEntry->Value->HashTree, Diff);
+
+	if (Entry->ChangedChildren.Num() > 0)
+	{
+		ListView->SetItemExpansion(Entry, true);
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -282,9 +551,11 @@ void SPropertyHistory::InitializeEntry(const TSharedPtr<FPropertyHistoryEntry>&
 void SPropertyEntry::Construct(
 	const FArguments& Args,
 	const TSharedRef<STableViewBase>& OwnerTableView,
-	const TSharedPtr<FPropertyHistoryEntry>& NewEntry)
+	const TSharedPtr<FPropertyHistoryEntry>& NewEntry,
+	const TSharedRef<FPropertyHistoryValueWidgetCache>& NewValueWidgetCache)
 {
 	WeakEntry = NewEntry;
+	ValueWidgetCache = NewValueWidgetCache;
 	FSuperRowType::Construct(Args, OwnerTableView);
 }
 
@@ -390,93 +661,14 @@ TSharedRef<SWidget> SPropertyEntry::GenerateWidgetForColumn(const FName& ColumnN
 
 		if (ColumnName == "Value")
 		{
-			const FPropertyBagPropertyDesc* PropertyDesc = Entry->Value.FindPropertyDescByName("Value");
-			if (!ensure(PropertyDesc))
+			if (const TSharedPtr<SWidget> CachedWidget = ValueWidgetCache->FindUnused(*Entry))
 			{
-				return SNullWidget::NullWidget;
+				return CachedWidget.ToSharedRef();
 			}
 
-			if (!Entry->Node)
-			{
-				return SNullWidget::NullWidget;
-			}
-
-			if (const TSharedPtr<IDetailPropertyRow> Row = Entry->Node->GetRow())
-			{
-				Row->ShowPropertyButtons(false);
-			}
-
-			const FNodeWidgets NodeWidgets = Entry->Node->CreateNodeWidgets();
-			if (!NodeWidgets.ValueWidget)
-			{
-				return SNullWidget::NullWidget;
-			}
-
-			const FVector2D ValueDesiredSize = PrivateAccess::ComputeDesiredSize(*NodeWidgets.ValueWidget)(1.f);
-			if (FMath::IsNearlyZero(ValueDesiredSize.X))
-			{
-				FString ToolTip;
-				const FString String = INLINE_LAMBDA -> FString
-				{
-					if (PropertyDesc->IsObjectType())
-					{
-						const TValueOrError<UObject*, EPropertyBagResult> WrappedObject = Entry->Value.GetValueObject("Value");
-						if (!WrappedObject.IsValid())
-						{
-							return "<Error>";
-						}
-
-						const UObject* Object = WrappedObject.GetValue();
-						if (!Object)
-						{
-							return "null";
-						}
-
-						ToolTip = Object->GetPathName();
-
-						return Object->GetName();
-					}
-
-					const TValueOrError<FString, EPropertyBagResult> Value = Entry->Value.GetValueSerializedString("Value");
-					if (!Value.IsValid())
-					{
-						return "<Error>";
-					}
-
-					return Value.GetValue();
-				};
-
-				if (ToolTip.IsEmpty())
-				{
-					ToolTip = String;
-				}
-
-				return
-					SNew(SBox)
-					.Padding(4.f, 0.f)
-					.HAlign(HAlign_Center)
-					.VAlign(VAlign_Center)
-					[
-						SNew(STextBlock)
-						.Text(FText::FromString(String))
-						.ToolTipText(FText::FromString(ToolTip))
-						.ColorAndOpacity(FSlateColor::UseForeground())
-					];
-			}
-
-			NodeWidgets.ValueWidget->SetEnabled(false);
-
-			return
-				SNew(SBox)
-				.Clipping(EWidgetClipping::OnDemand)
-				.HAlign(NodeWidgets.ValueWidgetLayoutData.HorizontalAlignment)
-				.VAlign(NodeWidgets.ValueWidgetLayoutData.VerticalAlignment)
-				.MinDesiredWidth(NodeWidgets.ValueWidgetLayoutData.MinWidth)
-				.MaxDesiredWidth(NodeWidgets.ValueWidgetLayoutData.MaxWidth)
-				.Padding(4.f, 0.f)
-				[
-					NodeWidgets.ValueWidget.ToSharedRef()
-				];
+			const TSharedRef<SWidget> ValueWidget = CreateValueWidget(*Entry);
+			ValueWidgetCache->Add(Entry, ValueWidget);
+			return ValueWidget;
 		}
 
 		if (ColumnName == "Author")
@@ -544,6 +736,88 @@ TSharedRef<SWidget> SPropertyEntry::GenerateWidgetForColumn(const FName& ColumnN
 		];
 }
 
+TSharedRef<SWidget> SPropertyEntry::CreateValueWidget(const FPropertyHistoryEntry& Entry)
+{
+	using EDisplayMode = FPropertyHistoryValue::EDisplayMode;
+
+	FPropertyHistoryValue& Value = *Entry.Value;
+
+	const FPropertyBagPropertyDesc* PropertyDesc = Value.Bag.FindPropertyDescByName("Value");
+	if (!ensure(PropertyDesc))
+	{
+		return SNullWidget::NullWidget;
+	}
+
+	if (!Entry.Node)
+	{
+		return SNullWidget::NullWidget;
+	}
+
+	FNodeWidgets NodeWidgets;
+	if (Value.DisplayMode != EDisplayMode::Text)
+	{
+		if (const TSharedPtr<IDetailPropertyRow> Row = Entry.Node->GetRow())
+		{
+			Row->ShowPropertyButtons(false);
+		}
+
+		NodeWidgets = Entry.Node->CreateNodeWidgets();
+		if (!NodeWidgets.ValueWidget)
+		{
+			return SNullWidget::NullWidget;
+		}
+	}
+
+	// Only computed once per distinct value, not every time a row is generated
+	if (Value.DisplayMode == EDisplayMode::Unknown)
+	{
+		const FVector2D ValueDesiredSize = PrivateAccess::ComputeDesiredSize(*NodeWidgets.ValueWidget)(1.f);
+		if (!FMath::IsNearlyZero(ValueDesiredSize.X))
+		{
+			Value.DisplayMode = EDisplayMode::Widget;
+		}
+		else
+		{
+			Value.DisplayMode = EDisplayMode::Text;
+			Value.DisplayText = Value.ExportText(&Value.DisplayToolTip);
+
+			if (Value.DisplayToolTip.IsEmpty())
+			{
+				Value.DisplayToolTip = Value.DisplayText;
+			}
+		}
+	}
+
+	if (Value.DisplayMode == EDisplayMode::Text)
+	{
+		return
+			SNew(SBox)
+			.Padding(4.f, 0.f)
+			.HAlign(HAlign_Center)
+			.VAlign(VAlign_Center)
+			[
+				SNew(STextBlock)
+				.Text(FText::FromString(Value.DisplayText))
+				.ToolTipText(FText::FromString(Value.DisplayToolTip))
+				.ColorAndOpacity(FSlateColor::UseForeground())
+			];
+	}
+
+	NodeWidgets.ValueWidget->SetEnabled(false);
+
+	return
+		SNew(SBox)
+		.Clipping(EWidgetClipping::OnDemand)
+		.HAlign(NodeWidgets.ValueWidgetLayoutData.HorizontalAlignment)
+		.VAlign(NodeWidgets.ValueWidgetLayoutData.VerticalAlignment)
+		.MinDesiredWidth(NodeWidgets.ValueWidgetLayoutData.MinWidth)
+		.MaxDesiredWidth(NodeWidgets.ValueWidgetLayoutData.MaxWidth)
+		.Padding(4.f, 0.f)
+		[
+			NodeWidgets.ValueWidget.ToSharedRef()
+		];
+}
+
 FSlateColor SPropertyEntry::GetRowBackgroundColor(const int32 IndentLevel, const bool bIsHovered)
 {
 	int32 ColorIndex = 0;
@@ -603,6 +877,31 @@ void SPropertyEntryValue::Construct(const FArguments& Args, const TSharedRef<STa
 			SNew(SPropertyEntryRowIndent, SharedThis(this))
 		];
 
+	NameColumnBox->AddSlot()
+		.HAlign(HAlign_Left)
+		.VAlign(VAlign_Fill)
+		.Padding(0.0f)
+		.AutoWidth()
+		[
+			SNew(SBox)
+			.WidthOverride(2.f)
+			[
+				SNew(SBorder)
+				.BorderImage(FAppStyle::Get().GetBrush("WhiteBrush"))
+				.BorderBackgroundColor_Lambda([WeakEntry = MakeWeakPtr(NewEntry)]() -> FSlateColor
+				{
+					const TSharedPtr<FPropertyHistoryEntry> Entry = WeakEntry.Pin();
+					if (Entry &&
+						Entry->bChanged)
+					{
+						return FStyleColors::AccentOrange;
+					}
+
+					return FStyleColors::Transparent;
+				})
+			]
+		];
+
 	NameColumnBox->AddSlot()
 		.HAlign(HAlign_Left)
 		.VAlign(VAlign_Center)
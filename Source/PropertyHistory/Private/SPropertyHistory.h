@@ -5,6 +5,28 @@
 #include "CoreMinimal.h"
 #include "DetailColumnSizeData.h"
 #include "PropertyHistoryHandler.h"
+#include "PropertyHistoryEntryIndex.h"
+
+// Value widgets are expensive to build: keep the ones of the last shown entries around
+// Per entry: a widget is only ever shown again for the entry it was built for, never recycled for another one
+// Entries own their widget, the cache only decides which ones to release
+class FPropertyHistoryValueWidgetCache
+{
+public:
+	// Null if the entry widget was released or is still used by another row
+	TSharedPtr<SWidget> FindUnused(const FPropertyHistoryEntry& Entry) const;
+	void Add(const TSharedPtr<FPropertyHistoryEntry>& Entry, const TSharedRef<SWidget>& Widget);
+	void Reset();
+
+private:
+	static constexpr int32 MaxNum = 512;
+
+	// Unique, least recently added first
+	TArray<TWeakPtr<FPropertyHistoryEntry>> Entries;
+};
+
+class SSearchBox;
+class SPropertyHistoryGraph;
 
 class SPropertyHistory : public SCompoundWidget
 {
@@ -16,16 +38,32 @@ public:
 	void SetHandler(const TSharedPtr<FPropertyHistoryHandler>& Handler);
 
 private:
+	void RefreshEntries();
+	void ApplyFilter();
+	void RefreshState();
 	void InitializeEntry(const TSharedPtr<FPropertyHistoryEntry>& Entry) const;
+	// Marks & expands the children of Entry whose value differ from OlderEntry
+	void DiffEntry(const TSharedPtr<FPropertyHistoryEntry>& Entry, const TSharedPtr<FPropertyHistoryEntry>& OlderEntry);
 
 private:
 	TSharedPtr<FPropertyHistoryHandler> PrivateHandler;
 	TSharedPtr<STreeView<TSharedPtr<FPropertyHistoryEntry>>> ListView;
 	TSharedPtr<SHeaderRow> HeaderRow;
+	TSharedPtr<SWidget> Throbber;
+	TSharedPtr<STextBlock> ErrorText;
+	TSharedPtr<SSearchBox> SearchBox;
+	TSharedPtr<SWidget> GraphPanel;
+	TSharedPtr<SPropertyHistoryGraph> Graph;
 
+	// Handler entries that pass the filter
 	TArray<TSharedPtr<FPropertyHistoryEntry>> Entries;
 
+	FString FilterText;
+	FPropertyHistoryEntryIndex EntryIndex;
+	bool bEntryIndexDirty = true;
+
 	TSharedPtr<FDetailColumnSizeData> ColumnSizeData;
+	TSharedRef<FPropertyHistoryValueWidgetCache> ValueWidgetCache = MakeShared<FPropertyHistoryValueWidgetCache>();
 };
 
 class SPropertyEntry : public SMultiColumnTableRow<TSharedPtr<FPropertyHistoryEntry>>
@@ -34,7 +72,8 @@ public:
 	void Construct(
 		const FArguments& Args,
 		const TSharedRef<STableViewBase>& OwnerTableView,
-		const TSharedPtr<FPropertyHistoryEntry>& NewEntry);
+		const TSharedPtr<FPropertyHistoryEntry>& NewEntry,
+		const TSharedRef<FPropertyHistoryValueWidgetCache>& NewValueWidgetCache);
 
 	//~ Begin SMultiColumnTableRow Interface
 	virtual void ConstructChildren(ETableViewMode::Type InOwnerTableMode, const TAttribute<FMargin>& InPadding, const TSharedRef<SWidget>& InContent) override;
@@ -46,6 +85,9 @@ public:
 
 private:
 	TWeakPtr<FPropertyHistoryEntry> WeakEntry;
+	TSharedPtr<FPropertyHistoryValueWidgetCache> ValueWidgetCache;
+
+	static TSharedRef<SWidget> CreateValueWidget(const FPropertyHistoryEntry& Entry);
 };
 
 class SPropertyEntryValue : public STableRow<TSharedPtr<FPropertyHistoryEntry>>
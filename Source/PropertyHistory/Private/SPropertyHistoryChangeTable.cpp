@@ -0,0 +1,197 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "SPropertyHistoryChangeTable.h"
+#include "ISourceControlRevision.h"
+#include "Widgets/Images/SThrobber.h"
+#include "Widgets/Layout/SScaleBox.h"
+
+void SPropertyHistoryChangeTable::Construct(const FArguments& Args)
+{
+	ChildSlot
+	[
+		SNew(SOverlay)
+		+ SOverlay::Slot()
+		[
+			SAssignNew(ListView, SListView<TSharedPtr<FPropertyHistoryChange>>)
+			.SelectionMode(ESelectionMode::Single)
+			.ListItemsSource(&Changes)
+			.HeaderRow(
+				SNew(SHeaderRow)
+
+				+ SHeaderRow::Column("CL")
+				.VAlignHeader(VAlign_Center)
+				.FillWidth(1.f)
+				.DefaultLabel(INVTEXT("CL"))
+
+				+ SHeaderRow::Column("Revision")
+				.VAlignHeader(VAlign_Center)
+				.FillWidth(1.5f)
+				.DefaultLabel(INVTEXT("Revision"))
+
+				+ SHeaderRow::Column("Name")
+				.VAlignHeader(VAlign_Center)
+				.FillWidth(3.f)
+				.DefaultLabel(INVTEXT("Name"))
+
+				+ SHeaderRow::Column("OldValue")
+				.VAlignHeader(VAlign_Center)
+				.FillWidth(3.f)
+				.DefaultLabel(INVTEXT("Old Value"))
+
+				+ SHeaderRow::Column("NewValue")
+				.VAlignHeader(VAlign_Center)
+				.FillWidth(3.f)
+				.DefaultLabel(INVTEXT("New Value"))
+
+				+ SHeaderRow::Column("Author")
+				.VAlignHeader(VAlign_Center)
+				.HAlignHeader(HAlign_Center)
+				.FillWidth(2.f)
+				.DefaultLabel(INVTEXT("Author"))
+
+				+ SHeaderRow::Column("Date")
+				.VAlignHeader(VAlign_Center)
+				.HAlignHeader(HAlign_Center)
+				.FillWidth(2.f)
+				.DefaultLabel(INVTEXT("Date"))
+			)
+			.OnGenerateRow_Lambda([](const TSharedPtr<FPropertyHistoryChange>& Change, const TSharedRef<STableViewBase>& OwnerTable)
+			{
+				return SNew(SPropertyHistoryChangeRow, OwnerTable, Change);
+			})
+		]
+		+ SOverlay::Slot()
+		.HAlign(HAlign_Center)
+		.VAlign(VAlign_Center)
+		[
+			SAssignNew(Throbber, SScaleBox)
+			.IgnoreInheritedScale(true)
+			.Visibility(EVisibility::Collapsed)
+			[
+				SNew(SThrobber)
+			]
+		]
+		+ SOverlay::Slot()
+		.HAlign(HAlign_Center)
+		.VAlign(VAlign_Bottom)
+		[
+			SAssignNew(ErrorText, STextBlock)
+			.ColorAndOpacity(FStyleColors::Error)
+			.Visibility(EVisibility::Collapsed)
+		]
+	];
+}
+
+void SPropertyHistoryChangeTable::SetTable(const TSharedPtr<FPropertyHistoryChangeTable>& Table)
+{
+	if (PrivateTable == Table)
+	{
+		Table->MakePriority();
+		return;
+	}
+
+	if (PrivateTable)
+	{
+		PrivateTable->OnChangesUpdated.RemoveAll(this);
+		PrivateTable->OnStateChanged.RemoveAll(this);
+		PrivateTable->Cancel();
+	}
+
+	PrivateTable = Table;
+	PrivateTable->MakePriority();
+
+	RefreshChanges();
+	RefreshState();
+
+	Table->OnChangesUpdated.AddSP(this, &SPropertyHistoryChangeTable::RefreshChanges);
+	Table->OnStateChanged.AddSP(this, &SPropertyHistoryChangeTable::RefreshState);
+}
+
+void SPropertyHistoryChangeTable::RefreshChanges()
+{
+	Changes = PrivateTable->Changes;
+	ListView->RequestListRefresh();
+}
+
+void SPropertyHistoryChangeTable::RefreshState()
+{
+	const bool bIsLoading = PrivateTable->IsLoading();
+	const TOptional<FString>& Error = PrivateTable->GetError();
+
+	Throbber->SetVisibility(bIsLoading ? EVisibility::Visible : EVisibility::Collapsed);
+
+	ErrorText->SetText(Error.IsSet() ? FText::FromString(Error.GetValue()) : FText());
+	ErrorText->SetVisibility(Error.IsSet() ? EVisibility::Visible : EVisibility::Collapsed);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void SPropertyHistoryChangeRow::Construct(
+	const FArguments& Args,
+	const TSharedRef<STableViewBase>& OwnerTableView,
+	const TSharedPtr<FPropertyHistoryChange>& NewChange)
+{
+	Change = NewChange;
+	FSuperRowType::Construct(Args, OwnerTableView);
+}
+
+TSharedRef<SWidget> SPropertyHistoryChangeRow::GenerateWidgetForColumn(const FName& ColumnName)
+{
+	const auto MakeText = [](const FString& String, const FSlateColor& Color = FSlateColor::UseForeground())
+	{
+		return
+			SNew(SBox)
+			.Padding(4.f, 0.f)
+			.VAlign(VAlign_Center)
+			[
+				SNew(STextBlock)
+				.Text(FText::FromString(String))
+				.ToolTipText(FText::FromString(String))
+				.OverflowPolicy(ETextOverflowPolicy::Ellipsis)
+				.ColorAndOpacity(Color)
+			];
+	};
+
+	if (ColumnName == "CL")
+	{
+		return MakeText(FString::FromInt(Change->Revision->GetCheckInIdentifier()));
+	}
+	if (ColumnName == "Revision")
+	{
+		return MakeText(Change->Revision->GetRevision());
+	}
+	if (ColumnName == "Name")
+	{
+		return MakeText(Change->Name);
+	}
+	if (ColumnName == "OldValue")
+	{
+		if (!Change->OldValue.IsSet())
+		{
+			return MakeText("Added", FSlateColor::UseSubduedForeground());
+		}
+
+		return MakeText(Change->OldValue.GetValue());
+	}
+	if (ColumnName == "NewValue")
+	{
+		if (!Change->NewValue.IsSet())
+		{
+			return MakeText("Removed", FSlateColor::UseSubduedForeground());
+		}
+
+		return MakeText(Change->NewValue.GetValue());
+	}
+	if (ColumnName == "Author")
+	{
+		return MakeText(Change->Revision->GetUserName());
+	}
+	if (ColumnName == "Date")
+	{
+		return MakeText(Change->Revision->GetDate().ToString());
+	}
+
+	return SNullWidget::NullWidget;
+}
@@ -0,0 +1,44 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PropertyHistoryChangeTable.h"
+
+class SPropertyHistoryChangeTable : public SCompoundWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SPropertyHistoryChangeTable) {}
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& Args);
+	void SetTable(const TSharedPtr<FPropertyHistoryChangeTable>& Table);
+
+private:
+	void RefreshChanges();
+	void RefreshState();
+
+private:
+	TSharedPtr<FPropertyHistoryChangeTable> PrivateTable;
+	TSharedPtr<SListView<TSharedPtr<FPropertyHistoryChange>>> ListView;
+	TSharedPtr<SWidget> Throbber;
+	TSharedPtr<STextBlock> ErrorText;
+
+	TArray<TSharedPtr<FPropertyHistoryChange>> Changes;
+};
+
+class SPropertyHistoryChangeRow : public SMultiColumnTableRow<TSharedPtr<FPropertyHistoryChange>>
+{
+public:
+	void Construct(
+		const FArguments& Args,
+		const TSharedRef<STableViewBase>& OwnerTableView,
+		const TSharedPtr<FPropertyHistoryChange>& NewChange);
+
+	//~ Begin SMultiColumnTableRow Interface
+	virtual TSharedRef<SWidget> GenerateWidgetForColumn(const FName& ColumnName) override;
+	//~ End SMultiColumnTableRow Interface
+
+private:
+	TSharedPtr<FPropertyHistoryChange> Change;
+};
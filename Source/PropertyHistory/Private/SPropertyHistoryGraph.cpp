@@ -0,0 +1,601 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "SPropertyHistoryGraph.h"
+#include "PropertyHistoryHandler.h"
+#include "ISourceControlRevision.h"
+#include "Algo/BinarySearch.h"
+#include "Fonts/FontMeasure.h"
+#include "Framework/Application/SlateApplication.h"
+
+namespace PropertyHistoryGraph
+{
+	using FChannelValues = TArray<TPair<FName, double>, TInlineAllocator<4>>;
+
+	// Numbers are a single channel, structs whose fields are all numbers one channel per field, eg X Y Z or R G B A
+	bool GetChannelValues(const FPropertyHistoryValue& Value, FChannelValues& OutValues)
+	{
+		// Read when the revision was processed
+		if (const FPropertyHistoryNumericColumns* Columns = Value.NumericColumns.Get())
+		{
+			for (int32 Channel = 0; Channel < Columns->NumChannels(); Channel++)
+			{
+				OutValues.Add({ Columns->GetChannelName(Channel), Columns->GetColumn(Channel)[Value.NumericRow] });
+			}
+			return true;
+		}
+
+		// Values without columns, eg instanced structs, are read from their bag
+		const FPropertyBagPropertyDesc* PropertyDesc = Value.Bag.FindPropertyDescByName("Value");
+		if (!PropertyDesc ||
+			!PropertyDesc->CachedProperty)
+		{
+			return false;
+		}
+
+		const FProperty& Property = *PropertyDesc->CachedProperty;
+		const void* Data = Property.ContainerPtrToValuePtr<void>(Value.Bag.GetValue().GetMemory());
+
+		const auto AddNumber = [&](const FProperty& NumberProperty, const void* NumberData)
+		{
+			const FNumericProperty* NumericProperty = CastField<FNumericProperty>(&NumberProperty);
+			if (!NumericProperty ||
+				// Byte enums
+				NumericProperty->IsEnum() ||
+				NumberProperty.ArrayDim != 1)
+			{
+				return false;
+			}
+
+			OutValues.Add({
+				NumberProperty.GetFName(),
+				NumericProperty->IsFloatingPoint()
+				? NumericProperty->GetFloatingPointPropertyValue(NumberData)
+				: double(NumericProperty->GetSignedIntPropertyValue(NumberData)) });
+			return true;
+		};
+
+		if (const FStructProperty* StructProperty = CastField<FStructProperty>(&Property))
+		{
+			for (TFieldIterator<FProperty> It(StructProperty->Struct); It; ++It)
+			{
+				if (OutValues.Num() == 4 ||
+					!AddNumber(**It, It->ContainerPtrToValuePtr<void>(Data)))
+				{
+					return false;
+				}
+			}
+
+			return OutValues.Num() > 0;
+		}
+
+		return AddNumber(Property, Data);
+	}
+
+	FLinearColor GetChannelColor(const FName Name, const int32 Index, const int32 NumChannels)
+	{
+		if (NumChannels == 1)
+		{
+			return FStyleColors::AccentOrange.GetSpecifiedColor();
+		}
+
+		static const FLinearColor Colors[] =
+		{
+			FLinearColor(0.90f, 0.25f, 0.20f),
+			FLinearColor(0.35f, 0.80f, 0.30f),
+			FLinearColor(0.30f, 0.55f, 1.00f),
+			FLinearColor(0.70f, 0.70f, 0.70f),
+		};
+
+		// FColor fields are B G R A
+		static const FName ColorChannels[] = { "R", "G", "B", "A" };
+		for (int32 ColorIndex = 0; ColorIndex < UE_ARRAY_COUNT(ColorChannels); ColorIndex++)
+		{
+			if (Name == ColorChannels[ColorIndex])
+			{
+				return Colors[ColorIndex];
+			}
+		}
+
+		return Colors[Index % UE_ARRAY_COUNT(Colors)];
+	}
+
+	FText FormatNumber(const double Value)
+	{
+		FNumberFormattingOptions Options;
+		Options.MaximumFractionalDigits = 3;
+		return FText::AsNumber(Value, &Options);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void SPropertyHistoryGraph::Construct(const FArguments& Args)
+{
+	OnEntryClicked = Args._OnEntryClicked;
+}
+
+bool SPropertyHistoryGraph::SetEntries(const TArray<TSharedPtr<FPropertyHistoryEntry>>& NewEntries)
+{
+	using namespace PropertyHistoryGraph;
+
+	const TSharedPtr<FPropertyHistoryEntry> SelectedEntry = Points.IsValidIndex(SelectedPoint) ? Points[SelectedPoint].Pin() : nullptr;
+
+	Points.Reset();
+	Dates.Reset();
+	Channels.Reset();
+	SelectedPoint = -1;
+	MinY = MAX_dbl;
+	MaxY = -MAX_dbl;
+	CachedNumColumns = -1;
+
+	Invalidate(EInvalidateWidgetReason::Paint);
+
+	// Entries sharing a value share its channels
+	TMap<const FPropertyHistoryValue*, FChannelValues> ValueToChannels;
+	// One column per channel, oldest first
+	TArray<TArray<double>, TInlineAllocator<4>> Columns;
+
+	for (int32 Index = NewEntries.Num() - 1; Index >= 0; Index--)
+	{
+		const TSharedPtr<FPropertyHistoryEntry>& Entry = NewEntries[Index];
+		if (!Entry->Value ||
+			!Entry->Revision)
+		{
+			continue;
+		}
+
+		const FChannelValues* Values = ValueToChannels.Find(Entry->Value.Get());
+		if (!Values)
+		{
+			FChannelValues NewValues;
+			if (!GetChannelValues(*Entry->Value, NewValues))
+			{
+				Points.Reset();
+				return false;
+			}
+			Values = &ValueToChannels.Add(Entry->Value.Get(), MoveTemp(NewValues));
+		}
+
+		if (Channels.Num() == 0)
+		{
+			for (const TPair<FName, double>& Value : *Values)
+			{
+				FChannel& Channel = Channels.Emplace_GetRef();
+				Channel.Name = Value.Key;
+				Channel.Color = GetChannelColor(Value.Key, Channels.Num() - 1, Values->Num());
+				Channel.Pyramid.Emplace();
+				Columns.Emplace();
+			}
+		}
+
+		// eg an instanced struct whose type changed
+		if (Values->Num() != Channels.Num())
+		{
+			Points.Reset();
+			return false;
+		}
+
+		for (int32 ChannelIndex = 0; ChannelIndex < Channels.Num(); ChannelIndex++)
+		{
+			const double Value = (*Values)[ChannelIndex].Value;
+			if ((*Values)[ChannelIndex].Key != Channels[ChannelIndex].Name)
+			{
+				Points.Reset();
+				return false;
+			}
+
+			Channels[ChannelIndex].Pyramid[0].Add({ Value, Value });
+			Columns[ChannelIndex].Add(Value);
+		}
+
+		if (Entry == SelectedEntry)
+		{
+			SelectedPoint = Points.Num();
+		}
+
+		Points.Add(Entry);
+		Dates.Add(Entry->Revision->GetDate());
+	}
+
+	if (Points.Num() == 0)
+	{
+		return false;
+	}
+
+	for (const TArray<double>& Column : Columns)
+	{
+		FPropertyHistoryNumericColumns::GetRange(Column, MinY, MaxY);
+	}
+
+	for (FChannel& Channel : Channels)
+	{
+		while (Channel.Pyramid.Last().Num() > 1)
+		{
+			const TArray<TPair<double, double>>& Level = Channel.Pyramid.Last();
+
+			TArray<TPair<double, double>> NextLevel;
+			NextLevel.Reserve((Level.Num() + 1) / 2);
+
+			for (int32 Index = 0; Index < Level.Num(); Index += 2)
+			{
+				TPair<double, double> Range = Level[Index];
+				if (Level.IsValidIndex(Index + 1))
+				{
+					Range.Key = FMath::Min(Range.Key, Level[Index + 1].Key);
+					Range.Value = FMath::Max(Range.Value, Level[Index + 1].Value);
+				}
+				NextLevel.Add(Range);
+			}
+
+			Channel.Pyramid.Add(MoveTemp(NextLevel));
+		}
+	}
+
+	UpdatePointX();
+	return true;
+}
+
+void SPropertyHistoryGraph::SetSelectedEntry(const TSharedPtr<FPropertyHistoryEntry>& Entry)
+{
+	SelectedPoint = Points.IndexOfByPredicate([&](const TWeakPtr<FPropertyHistoryEntry>& Point)
+	{
+		return Entry && Point.HasSameObject(Entry.Get());
+	});
+
+	Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+void SPropertyHistoryGraph::SetByDate(const bool bNewByDate)
+{
+	if (bByDate == bNewByDate)
+	{
+		return;
+	}
+
+	bByDate = bNewByDate;
+	UpdatePointX();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+int32 SPropertyHistoryGraph::OnPaint(
+	const FPaintArgs& Args,
+	const FGeometry& AllottedGeometry,
+	const FSlateRect& MyCullingRect,
+	FSlateWindowElementList& OutDrawElements,
+	const int32 LayerId,
+	const FWidgetStyle& InWidgetStyle,
+	const bool bParentEnabled) const
+{
+	using namespace PropertyHistoryGraph;
+
+	const FSlateRect PlotRect = GetPlotRect(AllottedGeometry);
+	const FVector2f PlotSize = FVector2f(PlotRect.GetSize());
+	if (Points.Num() == 0 ||
+		PlotSize.X < 1.f ||
+		PlotSize.Y < 1.f)
+	{
+		return LayerId;
+	}
+
+	const int32 NumColumns = FMath::FloorToInt(PlotSize.X);
+	if (CachedNumColumns != NumColumns)
+	{
+		UpdateColumns(NumColumns);
+	}
+
+	const FSlateBrush* WhiteBrush = FAppStyle::Get().GetBrush("WhiteBrush");
+	const FSlateFontInfo Font = FCoreStyle::GetDefaultFontStyle("Regular", 8);
+	const TSharedRef<FSlateFontMeasure> FontMeasure = FSlateApplication::Get().GetRenderer()->GetFontMeasureService();
+	const FLinearColor TextColor = FStyleColors::Foreground.GetColor(InWidgetStyle);
+
+	const auto MakeText = [&](const FText& Text, FVector2f Position, const FLinearColor& Color, const bool bAlignRight)
+	{
+		const FVector2f Size = FVector2f(FontMeasure->Measure(Text, Font));
+		if (bAlignRight)
+		{
+			Position.X -= Size.X;
+		}
+
+		FSlateDrawElement::MakeText(
+			OutDrawElements,
+			LayerId + 2,
+			AllottedGeometry.ToPaintGeometry(Size, FSlateLayoutTransform(Position)),
+			Text,
+			Font,
+			ESlateDrawEffect::None,
+			Color);
+
+		return Size.X;
+	};
+
+	FSlateDrawElement::MakeBox(
+		OutDrawElements,
+		LayerId,
+		AllottedGeometry.ToPaintGeometry(PlotSize, FSlateLayoutTransform(FVector2f(PlotRect.GetTopLeft()))),
+		WhiteBrush,
+		ESlateDrawEffect::None,
+		FStyleColors::Recessed.GetColor(InWidgetStyle));
+
+	if (Points.IsValidIndex(SelectedPoint))
+	{
+		const float X = GetPixelX(PointX[SelectedPoint], PlotRect);
+
+		FSlateDrawElement::MakeBox(
+			OutDrawElements,
+			LayerId + 1,
+			AllottedGeometry.ToPaintGeometry(FVector2f(1.f, PlotSize.Y), FSlateLayoutTransform(FVector2f(X, PlotRect.Top))),
+			WhiteBrush,
+			ESlateDrawEffect::None,
+			FStyleColors::Select.GetColor(InWidgetStyle));
+	}
+
+	const auto GetPixelY = [&](const float NormalizedY)
+	{
+		return PlotRect.Bottom - NormalizedY * PlotSize.Y;
+	};
+
+	// Points are only worth marking if they are far enough apart to be told apart
+	const bool bDrawPoints = Points.Num() <= NumColumns / 8;
+
+	for (int32 ChannelIndex = 0; ChannelIndex < Channels.Num(); ChannelIndex++)
+	{
+		const FLinearColor Color = Channels[ChannelIndex].Color;
+
+		TArray<FVector2f> LinePoints;
+		LinePoints.Reserve(2 * NumColumns);
+
+		for (int32 Column = 0; Column < NumColumns; Column++)
+		{
+			const TOptional<TPair<float, float>>& Range = CachedColumns[ChannelIndex][Column];
+			if (!Range)
+			{
+				continue;
+			}
+
+			const float X = PlotRect.Left + Column + 0.5f;
+			const float MinPixelY = GetPixelY(Range->Key);
+			const float MaxPixelY = GetPixelY(Range->Value);
+
+			if (MinPixelY == MaxPixelY)
+			{
+				LinePoints.Add(FVector2f(X, MinPixelY));
+				continue;
+			}
+
+			// Start with the end closest to the previous column
+			const bool bMinFirst = LinePoints.Num() > 0 && FMath::Abs(LinePoints.Last().Y - MinPixelY) < FMath::Abs(LinePoints.Last().Y - MaxPixelY);
+			LinePoints.Add(FVector2f(X, bMinFirst ? MinPixelY : MaxPixelY));
+			LinePoints.Add(FVector2f(X, bMinFirst ? MaxPixelY : MinPixelY));
+		}
+
+		if (LinePoints.Num() > 1)
+		{
+			FSlateDrawElement::MakeLines(
+				OutDrawElements,
+				LayerId + 1,
+				AllottedGeometry.ToPaintGeometry(),
+				LinePoints,
+				ESlateDrawEffect::None,
+				Color,
+				true,
+				1.5f);
+		}
+
+		if (!bDrawPoints &&
+			LinePoints.Num() > 1)
+		{
+			continue;
+		}
+
+		for (const FVector2f& Point : LinePoints)
+		{
+			FSlateDrawElement::MakeBox(
+				OutDrawElements,
+				LayerId + 1,
+				AllottedGeometry.ToPaintGeometry(FVector2f(4.f, 4.f), FSlateLayoutTransform(Point - FVector2f(2.f, 2.f))),
+				WhiteBrush,
+				ESlateDrawEffect::None,
+				Color);
+		}
+	}
+
+	MakeText(FormatNumber(MaxY), FVector2f(PlotRect.Left - 4.f, PlotRect.Top), TextColor, true);
+	MakeText(FormatNumber(MinY), FVector2f(PlotRect.Left - 4.f, PlotRect.Bottom - 12.f), TextColor, true);
+
+	MakeText(FText::AsDate(Dates[0]), FVector2f(PlotRect.Left, PlotRect.Bottom + 2.f), TextColor, false);
+	MakeText(FText::AsDate(Dates.Last()), FVector2f(PlotRect.Right, PlotRect.Bottom + 2.f), TextColor, true);
+
+	if (Channels.Num() > 1)
+	{
+		FVector2f Position(PlotRect.Left, 0.f);
+		for (const FChannel& Channel : Channels)
+		{
+			Position.X += MakeText(FText::FromName(Channel.Name), Position, Channel.Color, false) + 8.f;
+		}
+	}
+
+	return LayerId + 2;
+}
+
+FVector2D SPropertyHistoryGraph::ComputeDesiredSize(float LayoutScaleMultiplier) const
+{
+	return FVector2D(200.f, 100.f);
+}
+
+FReply SPropertyHistoryGraph::OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	if (MouseEvent.GetEffectingButton() != EKeys::LeftMouseButton ||
+		Points.Num() == 0)
+	{
+		return FReply::Unhandled();
+	}
+
+	const FSlateRect PlotRect = GetPlotRect(MyGeometry);
+	const FVector2f LocalPosition = MyGeometry.AbsoluteToLocal(MouseEvent.GetScreenSpacePosition());
+
+	double MinX = 0.;
+	double RangeX = 0.;
+	GetRangeX(MinX, RangeX);
+
+	const double X = MinX + (LocalPosition.X - PlotRect.Left) / FMath::Max(PlotRect.GetSize().X, 1.f) * RangeX;
+
+	const int32 Index = Algo::LowerBound(PointX, X);
+	int32 ClosestIndex = FMath::Min(Index, PointX.Num() - 1);
+	if (Index > 0 &&
+		FMath::Abs(PointX[Index - 1] - X) <= FMath::Abs(PointX[ClosestIndex] - X))
+	{
+		ClosestIndex = Index - 1;
+	}
+
+	if (FMath::Abs(GetPixelX(PointX[ClosestIndex], PlotRect) - LocalPosition.X) > 8.f)
+	{
+		return FReply::Handled();
+	}
+
+	SelectedPoint = ClosestIndex;
+	Invalidate(EInvalidateWidgetReason::Paint);
+
+	if (const TSharedPtr<FPropertyHistoryEntry> Entry = Points[ClosestIndex].Pin())
+	{
+		OnEntryClicked.ExecuteIfBound(Entry);
+	}
+
+	return FReply::Handled();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+TPair<double, double> SPropertyHistoryGraph::FChannel::GetRange(int32 Start, int32 End) const
+{
+	TPair<double, double> Range(MAX_dbl, -MAX_dbl);
+
+	// Each level halves the range: never more than two nodes per level
+	for (int32 LevelIndex = 0; Start < End; LevelIndex++)
+	{
+		const TArray<TPair<double, double>>& Level = Pyramid[LevelIndex];
+
+		if (Start & 1)
+		{
+			Range.Key = FMath::Min(Range.Key, Level[Start].Key);
+			Range.Value = FMath::Max(Range.Value, Level[Start].Value);
+			Start++;
+		}
+		if (End & 1)
+		{
+			End--;
+			Range.Key = FMath::Min(Range.Key, Level[End].Key);
+			Range.Value = FMath::Max(Range.Value, Level[End].Value);
+		}
+
+		Start /= 2;
+		End /= 2;
+	}
+
+	return Range;
+}
+
+void SPropertyHistoryGraph::UpdatePointX()
+{
+	PointX.Reset(Points.Num());
+
+	for (int32 Index = 0; Index < Points.Num(); Index++)
+	{
+		if (!bByDate)
+		{
+			PointX.Add(Index);
+			continue;
+		}
+
+		// Revisions are ordered by source control, their dates are not always: keep X sorted
+		const double Seconds = (Dates[Index] - Dates[0]).GetTotalSeconds();
+		PointX.Add(Index > 0 ? FMath::Max(PointX.Last(), Seconds) : 0.);
+	}
+
+	CachedNumColumns = -1;
+	Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+void SPropertyHistoryGraph::UpdateColumns(const int32 NumColumns) const
+{
+	CachedNumColumns = NumColumns;
+	CachedColumns.SetNum(Channels.Num());
+
+	double MinX = 0.;
+	double RangeX = 0.;
+	GetRangeX(MinX, RangeX);
+
+	const double RangeY = MaxY > MinY ? MaxY - MinY : 2.;
+	const double OffsetY = MaxY > MinY ? MinY : MinY - 1.;
+
+	for (TArray<TOptional<TPair<float, float>>>& Columns : CachedColumns)
+	{
+		Columns.Reset(NumColumns);
+	}
+
+	// One binary search & one pyramid lookup per column, no matter how many points
+	int32 Start = 0;
+	for (int32 Column = 0; Column < NumColumns; Column++)
+	{
+		const int32 End = Column == NumColumns - 1
+			? PointX.Num()
+			: Algo::LowerBound(PointX, MinX + RangeX * (Column + 1) / NumColumns);
+
+		for (int32 ChannelIndex = 0; ChannelIndex < Channels.Num(); ChannelIndex++)
+		{
+			if (Start >= End)
+			{
+				CachedColumns[ChannelIndex].Add({});
+				continue;
+			}
+
+			const TPair<double, double> Range = Channels[ChannelIndex].GetRange(Start, End);
+			CachedColumns[ChannelIndex].Add(TPair<float, float>(
+				(Range.Key - OffsetY) / RangeY,
+				(Range.Value - OffsetY) / RangeY));
+		}
+
+		Start = FMath::Max(Start, End);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void SPropertyHistoryGraph::GetRangeX(double& OutMinX, double& OutRangeX) const
+{
+	if (PointX.Num() == 0 ||
+		PointX.Last() <= PointX[0])
+	{
+		// Single point: centered
+		OutMinX = PointX.Num() > 0 ? PointX[0] - 1. : 0.;
+		OutRangeX = 2.;
+		return;
+	}
+
+	OutMinX = PointX[0];
+	OutRangeX = PointX.Last() - PointX[0];
+}
+
+FSlateRect SPropertyHistoryGraph::GetPlotRect(const FGeometry& Geometry)
+{
+	// Room for the value labels on the left, the legend above & the dates below
+	const FVector2f Size = FVector2f(Geometry.GetLocalSize());
+	return FSlateRect(56.f, 16.f, FMath::Max(56.f, Size.X - 8.f), FMath::Max(16.f, Size.Y - 16.f));
+}
+
+float SPropertyHistoryGraph::GetPixelX(const double X, const FSlateRect& PlotRect) const
+{
+	double MinX = 0.;
+	double RangeX = 0.;
+	GetRangeX(MinX, RangeX);
+
+	return PlotRect.Left + (X - MinX) / RangeX * PlotRect.GetSize().X;
+}
@@ -0,0 +1,77 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SLeafWidget.h"
+
+struct FPropertyHistoryEntry;
+
+// Plots numeric values over time: numbers as one line, structs of numbers such as vectors or colors as one line per field
+// Points are reduced to the min & max of each pixel column, so painting costs the same for 10 or 100k revisions
+class SPropertyHistoryGraph : public SLeafWidget
+{
+public:
+	DECLARE_DELEGATE_OneParam(FOnEntryClicked, const TSharedPtr<FPropertyHistoryEntry>&);
+
+	SLATE_BEGIN_ARGS(SPropertyHistoryGraph) {}
+		SLATE_EVENT(FOnEntryClicked, OnEntryClicked)
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& Args);
+
+	// Entries newest first. False if their values cannot be plotted
+	bool SetEntries(const TArray<TSharedPtr<FPropertyHistoryEntry>>& NewEntries);
+	void SetSelectedEntry(const TSharedPtr<FPropertyHistoryEntry>& Entry);
+	// Points are spaced by date instead of one per revision
+	void SetByDate(bool bNewByDate);
+
+	//~ Begin SLeafWidget Interface
+	virtual int32 OnPaint(
+		const FPaintArgs& Args,
+		const FGeometry& AllottedGeometry,
+		const FSlateRect& MyCullingRect,
+		FSlateWindowElementList& OutDrawElements,
+		int32 LayerId,
+		const FWidgetStyle& InWidgetStyle,
+		bool bParentEnabled) const override;
+	virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override;
+	virtual FReply OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	//~ End SLeafWidget Interface
+
+private:
+	struct FChannel
+	{
+		FName Name;
+		FLinearColor Color;
+		// Level 0 is one min & max per point, each next level the min & max of pairs of the previous one
+		TArray<TArray<TPair<double, double>>> Pyramid;
+
+		// Min & max of the points in [Start, End)
+		TPair<double, double> GetRange(int32 Start, int32 End) const;
+	};
+
+	FOnEntryClicked OnEntryClicked;
+	bool bByDate = false;
+
+	// Oldest first
+	TArray<TWeakPtr<FPropertyHistoryEntry>> Points;
+	// Revision index or date in seconds, ascending
+	TArray<double> PointX;
+	TArray<FDateTime> Dates;
+	TArray<FChannel> Channels;
+	double MinY = 0.;
+	double MaxY = 0.;
+	int32 SelectedPoint = -1;
+
+	// One min & max per pixel column & channel, normalized. Rebuilt when the points or the width change
+	mutable TArray<TArray<TOptional<TPair<float, float>>>> CachedColumns;
+	mutable int32 CachedNumColumns = -1;
+
+	void UpdatePointX();
+	void UpdateColumns(int32 NumColumns) const;
+
+	void GetRangeX(double& OutMinX, double& OutRangeX) const;
+	static FSlateRect GetPlotRect(const FGeometry& Geometry);
+	float GetPixelX(double X, const FSlateRect& PlotRect) const;
+};
@@ -0,0 +1,209 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "SPropertyHistoryMulti.h"
+#include "ISourceControlRevision.h"
+#include "Widgets/Images/SThrobber.h"
+#include "Widgets/Layout/SScaleBox.h"
+
+void SPropertyHistoryMulti::Construct(const FArguments& Args)
+{
+	ChildSlot
+	[
+		SNew(SOverlay)
+		+ SOverlay::Slot()
+		[
+			SAssignNew(ListView, SListView<TSharedPtr<FPropertyHistoryMultiRow>>)
+			.SelectionMode(ESelectionMode::Single)
+			.ListItemsSource(&Rows)
+			.HeaderRow(SAssignNew(HeaderRow, SHeaderRow))
+			.OnGenerateRow_Lambda([](const TSharedPtr<FPropertyHistoryMultiRow>& Row, const TSharedRef<STableViewBase>& OwnerTable)
+			{
+				return SNew(SPropertyHistoryMultiRow, OwnerTable, Row);
+			})
+		]
+		+ SOverlay::Slot()
+		.HAlign(HAlign_Center)
+		.VAlign(VAlign_Center)
+		[
+			SAssignNew(Throbber, SScaleBox)
+			.IgnoreInheritedScale(true)
+			.Visibility(EVisibility::Collapsed)
+			[
+				SNew(SThrobber)
+			]
+		]
+		+ SOverlay::Slot()
+		.HAlign(HAlign_Center)
+		.VAlign(VAlign_Bottom)
+		[
+			SAssignNew(ErrorText, STextBlock)
+			.ColorAndOpacity(FStyleColors::Error)
+			.Visibility(EVisibility::Collapsed)
+		]
+	];
+}
+
+void SPropertyHistoryMulti::SetHandler(const TSharedPtr<FPropertyHistoryMultiHandler>& Handler)
+{
+	if (PrivateHandler == Handler)
+	{
+		return;
+	}
+
+	if (PrivateHandler)
+	{
+		PrivateHandler->OnRowsUpdated.RemoveAll(this);
+		PrivateHandler->OnStateChanged.RemoveAll(this);
+		PrivateHandler->Cancel();
+	}
+
+	PrivateHandler = Handler;
+
+	RefreshColumns();
+	RefreshRows();
+	RefreshState();
+
+	Handler->OnRowsUpdated.AddSP(this, &SPropertyHistoryMulti::RefreshRows);
+	Handler->OnStateChanged.AddSP(this, &SPropertyHistoryMulti::RefreshState);
+}
+
+void SPropertyHistoryMulti::RefreshColumns()
+{
+	HeaderRow->ClearColumns();
+
+	HeaderRow->AddColumn(
+		SHeaderRow::Column("CL")
+		.VAlignHeader(VAlign_Center)
+		.FillWidth(1.f)
+		.DefaultLabel(INVTEXT("CL")));
+
+	HeaderRow->AddColumn(
+		SHeaderRow::Column("Author")
+		.VAlignHeader(VAlign_Center)
+		.HAlignHeader(HAlign_Center)
+		.FillWidth(1.5f)
+		.DefaultLabel(INVTEXT("Author")));
+
+	HeaderRow->AddColumn(
+		SHeaderRow::Column("Date")
+		.VAlignHeader(VAlign_Center)
+		.HAlignHeader(HAlign_Center)
+		.FillWidth(2.f)
+		.DefaultLabel(INVTEXT("Date")));
+
+	HeaderRow->AddColumn(
+		SHeaderRow::Column("Description")
+		.VAlignHeader(VAlign_Center)
+		.FillWidth(3.f)
+		.DefaultLabel(INVTEXT("Description")));
+
+	// One column per object, named by index as labels are not unique
+	const TArray<FString>& ObjectNames = PrivateHandler->GetObjectNames();
+	for (int32 Index = 0; Index < ObjectNames.Num(); Index++)
+	{
+		HeaderRow->AddColumn(
+			SHeaderRow::Column(FName("Object", Index + 1))
+			.VAlignHeader(VAlign_Center)
+			.FillWidth(2.f)
+			.DefaultLabel(FText::FromString(ObjectNames[Index]))
+			.DefaultTooltip(FText::FromString(ObjectNames[Index])));
+	}
+
+	// Rows cache their cells
+	ListView->RebuildList();
+}
+
+void SPropertyHistoryMulti::RefreshRows()
+{
+	Rows = PrivateHandler->Rows;
+	ListView->RequestListRefresh();
+}
+
+void SPropertyHistoryMulti::RefreshState()
+{
+	const bool bIsLoading = PrivateHandler->IsLoading();
+	const TOptional<FString> Error = PrivateHandler->GetError();
+
+	Throbber->SetVisibility(bIsLoading ? EVisibility::Visible : EVisibility::Collapsed);
+
+	ErrorText->SetText(Error.IsSet() ? FText::FromString(Error.GetValue()) : FText());
+	ErrorText->SetVisibility(Error.IsSet() ? EVisibility::Visible : EVisibility::Collapsed);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void SPropertyHistoryMultiRow::Construct(
+	const FArguments& Args,
+	const TSharedRef<STableViewBase>& OwnerTableView,
+	const TSharedPtr<FPropertyHistoryMultiRow>& NewRow)
+{
+	Row = NewRow;
+	FSuperRowType::Construct(Args, OwnerTableView);
+}
+
+TSharedRef<SWidget> SPropertyHistoryMultiRow::GenerateWidgetForColumn(const FName& ColumnName)
+{
+	const auto MakeText = [](const FString& String, const FString& ToolTip, const FSlateColor& Color = FSlateColor::UseForeground())
+	{
+		return
+			SNew(SBox)
+			.Padding(4.f, 0.f)
+			.VAlign(VAlign_Center)
+			[
+				SNew(STextBlock)
+				.Text(FText::FromString(String))
+				.ToolTipText(FText::FromString(ToolTip))
+				.OverflowPolicy(ETextOverflowPolicy::Ellipsis)
+				.ColorAndOpacity(Color)
+			];
+	};
+
+	const ISourceControlRevision& Revision = *Row->Revision;
+
+	if (ColumnName == "CL")
+	{
+		const FString CL = FString::FromInt(Revision.GetCheckInIdentifier());
+		return MakeText(CL, CL);
+	}
+	if (ColumnName == "Author")
+	{
+		return MakeText(Revision.GetUserName(), Revision.GetUserName());
+	}
+	if (ColumnName == "Date")
+	{
+		const FString Date = Revision.GetDate().ToString();
+		return MakeText(Date, Date);
+	}
+	if (ColumnName == "Description")
+	{
+		return MakeText(Revision.GetDescription(), Revision.GetDescription());
+	}
+
+	if (ColumnName.GetComparisonIndex() != FName("Object").GetComparisonIndex())
+	{
+		return SNullWidget::NullWidget;
+	}
+
+	const int32 Index = ColumnName.GetNumber() - 1;
+	if (!ensure(Row->Values.IsValidIndex(Index)))
+	{
+		return SNullWidget::NullWidget;
+	}
+
+	const TSharedPtr<FPropertyHistoryValue> Value = Row->Values[Index];
+	if (!Value)
+	{
+		return MakeText("", "No history yet", FSlateColor::UseSubduedForeground());
+	}
+
+	FString ToolTip;
+	const FString Text = Value->ExportText(&ToolTip);
+
+	// Values carried over from an older revision are dimmed, changes stand out
+	return MakeText(
+		Text,
+		ToolTip.IsEmpty() ? Text : ToolTip,
+		Row->Changed[Index] ? FSlateColor(FStyleColors::AccentOrange) : FSlateColor::UseSubduedForeground());
+}
@@ -0,0 +1,46 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PropertyHistoryMultiHandler.h"
+
+class SPropertyHistoryMulti : public SCompoundWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SPropertyHistoryMulti) {}
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& Args);
+	void SetHandler(const TSharedPtr<FPropertyHistoryMultiHandler>& Handler);
+
+private:
+	void RefreshColumns();
+	void RefreshRows();
+	void RefreshState();
+
+private:
+	TSharedPtr<FPropertyHistoryMultiHandler> PrivateHandler;
+	TSharedPtr<SHeaderRow> HeaderRow;
+	TSharedPtr<SListView<TSharedPtr<FPropertyHistoryMultiRow>>> ListView;
+	TSharedPtr<SWidget> Throbber;
+	TSharedPtr<STextBlock> ErrorText;
+
+	TArray<TSharedPtr<FPropertyHistoryMultiRow>> Rows;
+};
+
+class SPropertyHistoryMultiRow : public SMultiColumnTableRow<TSharedPtr<FPropertyHistoryMultiRow>>
+{
+public:
+	void Construct(
+		const FArguments& Args,
+		const TSharedRef<STableViewBase>& OwnerTableView,
+		const TSharedPtr<FPropertyHistoryMultiRow>& NewRow);
+
+	//~ Begin SMultiColumnTableRow Interface
+	virtual TSharedRef<SWidget> GenerateWidgetForColumn(const FName& ColumnName) override;
+	//~ End SMultiColumnTableRow Interface
+
+private:
+	TSharedPtr<FPropertyHistoryMultiRow> Row;
+};
@@ -21,6 +21,7 @@ public class PropertyHistory : ModuleRules
 			"SlateCore",
 			"InputCore",
 			"UnrealEd",
+			"AssetRegistry",
 			"ToolMenus",
 			"SceneOutliner",
 			"MaterialEditor",
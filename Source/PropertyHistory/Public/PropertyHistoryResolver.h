@@ -0,0 +1,60 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/TopLevelAssetPath.h"
+
+enum class EPropertyHistoryResolverInputs : uint8
+{
+	None = 0,
+	// Next property of the chain, can be replaced by the resolver
+	ChildProperty = 1 << 0,
+	// Guid of the property, eg a parameter guid. Resolvers needing it are skipped if it's not set
+	Guid = 1 << 1,
+};
+ENUM_CLASS_FLAGS(EPropertyHistoryResolverInputs);
+
+struct FPropertyHistoryResolveContext
+{
+	// Container of Property on input, container of the child property on output
+	void* Container = nullptr;
+	const FProperty* Property = nullptr;
+
+	// Only set if requested through GetInputs
+	const FProperty* ChildProperty = nullptr;
+	FGuid Guid;
+
+	// Struct actually stored behind the last resolved property, eg the stamp type of a stamp ref
+	// Kept across the whole chain
+	const UScriptStruct* TargetStruct = nullptr;
+};
+
+// Steps through a property whose value is not laid out like its type says, eg instanced structs
+class PROPERTYHISTORY_API IPropertyHistoryResolver
+{
+public:
+	virtual ~IPropertyHistoryResolver() = default;
+
+	virtual EPropertyHistoryResolverInputs GetInputs() const
+	{
+		return EPropertyHistoryResolverInputs::None;
+	}
+
+	// Returns false if the property can't be found in that revision
+	virtual bool Resolve(FPropertyHistoryResolveContext& Context) const = 0;
+};
+
+// Resolvers are looked up by the struct of struct properties, or by the field class of other properties
+// Structs are registered by path so that they can be registered before their module is loaded
+class PROPERTYHISTORY_API FPropertyHistoryResolvers
+{
+public:
+	static void RegisterStruct(const FTopLevelAssetPath& StructPath, const TSharedRef<const IPropertyHistoryResolver>& Resolver);
+	static void RegisterFieldClass(const FFieldClass& FieldClass, const TSharedRef<const IPropertyHistoryResolver>& Resolver);
+
+	static void UnregisterStruct(const FTopLevelAssetPath& StructPath);
+	static void UnregisterFieldClass(const FFieldClass& FieldClass);
+
+	static const IPropertyHistoryResolver* Find(const FProperty& Property);
+};